@@ -0,0 +1,147 @@
+/*******************************************************************************
+ * logger_config.cpp ***********************************************************
+ *******************************************************************************/
+
+#include "logger_config.h"
+#include <EEPROM.h>
+#include <common/peak_tracker.h>
+
+const byte config_magic = 'L';
+const byte no_store_step = 255;
+
+// Steps of the store: invalidate the magic, the settings, the checksum, the magic:
+const byte checksum_store_step = 1 + sizeof(Logger_settings);
+const byte magic_store_step = checksum_store_step + 1;
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Logger_config::Logger_config(Logger_settings defaults, int eeprom_address) {
+  _defaults = defaults;
+  _settings = defaults;
+  _pending_settings = defaults;
+  _has_pending_settings = false;
+  _eeprom_address = eeprom_address;
+  _store_step = no_store_step;
+}
+
+// EEPROM ----------------------------------------------------------------------
+void Logger_config::load() {
+  _settings = _defaults;
+  if (EEPROM.read(_eeprom_address) != config_magic) {
+    return;
+  }
+  Logger_settings settings;
+  byte *bytes = reinterpret_cast<byte *>(&settings);
+  for (byte i = 0; i < sizeof(Logger_settings); i++) {
+    bytes[i] = EEPROM.read(_eeprom_address + 1 + i);
+  }
+  byte checksum = EEPROM.read(_eeprom_address + 1 + sizeof(Logger_settings));
+  if (checksum != calculate_checksum(settings) || !settings_are_valid(settings)) {
+    return;
+  }
+  _settings = settings;
+}
+
+void Logger_config::update() {
+  if (_store_step == no_store_step) {
+    return;
+  }
+#ifdef __AVR__
+  if (!eeprom_is_ready()) {
+    return; // the previous write is still running
+  }
+#endif
+  if (_store_step == 0) {
+    EEPROM.update(_eeprom_address, 0xFF); // erased, not valid until the store is completed
+  } else if (_store_step < checksum_store_step) {
+    const byte *bytes = reinterpret_cast<const byte *>(&_settings);
+    EEPROM.update(_eeprom_address + _store_step, bytes[_store_step - 1]);
+  } else if (_store_step == checksum_store_step) {
+    EEPROM.update(_eeprom_address + checksum_store_step, calculate_checksum(_settings));
+  } else {
+    EEPROM.update(_eeprom_address, config_magic);
+  }
+  _store_step = _store_step < magic_store_step ? _store_step + 1 : no_store_step;
+}
+
+byte Logger_config::calculate_checksum(const Logger_settings &settings) {
+  const byte *bytes = reinterpret_cast<const byte *>(&settings);
+  byte checksum = 0;
+  for (byte i = 0; i < sizeof(Logger_settings); i++) {
+    checksum = (checksum << 1 | checksum >> 7) ^ bytes[i]; // rotate and xor
+  }
+  return checksum;
+}
+
+// COMMANDS --------------------------------------------------------------------
+bool Logger_config::key_is(const char *key, byte key_length, const char *name) {
+  return key_length == strlen(name) && strncmp(key, name, key_length) == 0;
+}
+
+// CONFIG;<KEY>;<value>;
+bool Logger_config::handle_command(const char *command) {
+  const char *prefix = "CONFIG;";
+  if (strncmp(command, prefix, strlen(prefix)) != 0) {
+    return false;
+  }
+  const char *key = command + strlen(prefix);
+  const char *value_text = strchr(key, ';');
+  if (!value_text) {
+    return false;
+  }
+  byte key_length = value_text - key;
+  char *end;
+  long value = strtol(++value_text, &end, 10);
+  if (end == value_text || (*end != ';' && *end != '\0')) {
+    return false;
+  }
+
+  // Values out of the int range are limited to an invalid value:
+  Logger_settings settings = _has_pending_settings ? _pending_settings : _settings;
+  if (key_is(key, key_length, "START_THRESHOLD")) {
+    settings.start_threshold = value;
+  } else if (key_is(key, key_length, "STOP_THRESHOLD")) {
+    settings.stop_threshold = value;
+  } else if (key_is(key, key_length, "CLAMP_RANGE")) {
+    settings.clamp_range = min(max(value, -1L), 32767L);
+  } else if (key_is(key, key_length, "ZERO_OFFSET")) {
+    settings.zero_offset = min(max(value, -1L), 32767L);
+  } else if (key_is(key, key_length, "PEAK_COUNT")) {
+    settings.peak_count = min(max(value, 0L), 255L);
+  } else {
+    return false;
+  }
+  if (!settings_are_valid(settings)) {
+    return false;
+  }
+  _pending_settings = settings;
+  _has_pending_settings = true;
+  return true;
+}
+
+void Logger_config::apply_pending_settings() {
+  if (!_has_pending_settings) {
+    return;
+  }
+  _settings = _pending_settings;
+  _has_pending_settings = false;
+  _store_step = 0; // also restarts a running store
+}
+
+bool Logger_config::settings_are_valid(const Logger_settings &settings) {
+  if (settings.clamp_range < 1 || settings.clamp_range > 2000) {
+    return false;
+  }
+  if (settings.zero_offset < 0 || settings.zero_offset > 511) {
+    return false;
+  }
+  if (settings.peak_count < 1 || settings.peak_count > PEAK_TRACKER_MAX_SIZE) {
+    return false;
+  }
+  return settings.stop_threshold >= 0 && settings.stop_threshold < settings.start_threshold &&
+         settings.start_threshold <= settings.clamp_range * 100L;
+}
+
+// GETTER ----------------------------------------------------------------------
+const Logger_settings &Logger_config::get_settings() { return _settings; }
+
+bool Logger_config::has_pending_settings() { return _has_pending_settings; }
@@ -0,0 +1,74 @@
+/* *****************************************************************************
+ * logger_config.h *************************************************************
+ * *****************************************************************************
+ * Settings of the current logger that can be changed by serial commands,
+ * without reflashing the arduino:
+ * CONFIG;<KEY>;<value>;
+ *
+ * KEY               UNIT     RANGE
+ * START_THRESHOLD   [0.01A]  above STOP_THRESHOLD, up to the clamp range
+ * STOP_THRESHOLD    [0.01A]  0 to below START_THRESHOLD
+ * CLAMP_RANGE       [A]      1-2000, current at the full ADC range
+ * ZERO_OFFSET       [adc]    0-511, ADC value at 0A
+ * PEAK_COUNT                 1-PEAK_TRACKER_MAX_SIZE, the logged peak is the
+ *                            smallest of the PEAK_COUNT biggest values
+ *
+ * A valid value becomes a pending setting, an invalid command changes
+ * nothing. The caller applies the pending settings with
+ * apply_pending_settings() when it suits, e.g. between two strokes.
+ * Applied settings are stored in EEPROM (LOGGER_CONFIG_EEPROM_SIZE bytes at
+ * the address of the config) and are valid after a restart. If the EEPROM
+ * holds no valid config, the defaults are used.
+ *
+ * An EEPROM write takes 3.3ms, update() writes one byte per call and only
+ * when the EEPROM is ready, so storing never blocks the loop. The magic is
+ * invalidated first and written last, an interrupted store is not loaded.
+ * EEPROM LAYOUT: magic 'L', settings, checksum
+ * *****************************************************************************
+ */
+
+#ifndef LOGGERCONFIG_H
+#define LOGGERCONFIG_H
+
+#include <Arduino.h>
+
+struct Logger_settings {
+  long start_threshold; // [0.01A]
+  long stop_threshold; // [0.01A]
+  int clamp_range; // [A]
+  int zero_offset; // [adc]
+  byte peak_count;
+};
+
+#define LOGGER_CONFIG_EEPROM_SIZE (2 + sizeof(Logger_settings))
+
+class Logger_config {
+
+public:
+  // FUNCTIONS:
+  Logger_config(Logger_settings defaults, int eeprom_address);
+
+  void load();
+  bool handle_command(const char *command); // true if a valid setting is pending
+  void apply_pending_settings(); // starts the store
+  void update(); // stores the next byte
+
+  // GETTER:
+  const Logger_settings &get_settings(); // applied settings
+  bool has_pending_settings();
+
+private:
+  // VARIABLES:
+  Logger_settings _defaults;
+  Logger_settings _settings;
+  Logger_settings _pending_settings;
+  bool _has_pending_settings;
+  int _eeprom_address;
+  byte _store_step; // next step of the store, no_store_step when stored
+
+  // FUNCTIONS:
+  bool key_is(const char *key, byte key_length, const char *name);
+  bool settings_are_valid(const Logger_settings &settings);
+  byte calculate_checksum(const Logger_settings &settings);
+};
+#endif
@@ -1,6 +1,12 @@
 #include <Arduino.h>
 #include <Insomnia.h> //         https://github.com/chischte/insomnia-delay-library
-#include <RunningMedian.h>
+#include <common/heap_monitor.h> //  counts heap allocations since startup
+#include <common/peak_tracker.h> //  biggest values of a tool cycle
+#include <common/sensor_conversion.h> //  fixed point sensor conversions, calibration in EEPROM
+#include <common/small_string.h> //  allocation free text formatting
+#include <arduino_current_logger/logger_config.h> // settings changed by serial commands
+#include <arduino_current_logger/stroke_capture.h> // current curve of every tool stroke
+#include <arduino_current_logger/timed_sampler.h> // analog input sampled at a fixed rate
 
 // PIN DEFINITION -----------------------------------------------------------
 // INPUT:
@@ -9,43 +15,126 @@ const byte CURRENT_CLAMP_IN = A0;
 // CREATE OBJECTS --------------------------------------------------------------
 Insomnia status_print_delay;
 
-// STORE PEAK VALUES:
-RunningMedian currents_median_cache = RunningMedian(20);
+// SETTINGS, CHANGED BY SERIAL COMMANDS (CONFIG AT EEPROM ADDRESS 64):
+// start threshold [0.01A], stop threshold [0.01A], clamp range [A], zero offset [adc], peak count
+const Logger_settings default_settings = {3500, 500, 100, 0, 5};
+Logger_config logger_config(default_settings, 64);
 
-// VARIOUS FUNCTIONS -----------------------------------------------------------
+// STORE PEAK VALUES (RAW ADC VALUES):
+Peak_tracker current_peaks(default_settings.peak_count);
 
-float calculate_amps_from_adc(int adc_value) {
-  float adc_range = 1024;
-  float amps_at_max = 100;
-  float amps = float(adc_value) / adc_range * amps_at_max;
-  return amps;
-}
+// INTEGRATE THE CURRENT OF THE STROKE (RAW ADC VALUES):
+const long nominal_battery_voltage = 18; // [V] for the estimated energy
+unsigned long stroke_adc_sum = 0; // fits 1023 * 4000Hz for 1000s
+unsigned long stroke_no_of_samples = 0;
+
+// CURRENT CONVERSION [0.01A] (CALIBRATION TABLE AT EEPROM ADDRESS 0):
+// The scale follows the clamp range of the settings
+Sensor_conversion current_conversion(make_fixed_point_scale(100.0 * 100 / 1024, 1023), 0);
+
+// SAMPLE THE CURRENT AT A FIXED RATE (USES TIMER1 AND THE ADC):
+const unsigned int current_sample_rate = 4000; // [Hz]
+Timed_sampler current_sampler(CURRENT_CLAMP_IN, current_sample_rate);
+int last_adc_value = 0; // latest sample
+
+// CAPTURE THE CURRENT CURVE OF EVERY STROKE (ONE POINT PER 10ms, THE MAX OF ITS SAMPLES):
+Stroke_capture current_capture(current_sample_rate / 100, 10);
+
+// CYCLE DETECTION THRESHOLDS, CONVERTED TO ADC VALUES WHEN THE SETTINGS ARE APPLIED:
+int cycle_start_adc_value; // current is over the threshold from this value
+int cycle_stop_adc_value;
+
+// VARIOUS FUNCTIONS -----------------------------------------------------------
 
-float get_amps_from_clamp() {
-  float amps = calculate_amps_from_adc(analogRead(CURRENT_CLAMP_IN));
-  return amps;
+// LOG;CURRENT_LOGGER_RUNNING;<current>;<heap allocations>;<lost samples>;<dropped stroke reports>;
+// <start threshold>;<stop threshold>;<clamp range>;<zero offset>;<peak count>;
+void send_device_status() {
+  const Logger_settings &settings = logger_config.get_settings();
+  Small_string<96> status_text;
+  status_text.print(F("LOG;CURRENT_LOGGER_RUNNING;"));
+  status_text.print_fixed(current_conversion.convert(last_adc_value), 2); // [A]
+  status_text.print(F(";"));
+  status_text.print(get_heap_allocation_count());
+  status_text.print(F(";"));
+  status_text.print(current_sampler.get_lost_values()); // should stay 0
+  status_text.print(F(";"));
+  status_text.print(current_capture.get_no_of_dropped_reports()); // should stay 0
+  status_text.print(F(";"));
+  status_text.print_fixed(settings.start_threshold, 2); // [A]
+  status_text.print(F(";"));
+  status_text.print_fixed(settings.stop_threshold, 2); // [A]
+  status_text.print(F(";"));
+  status_text.print(settings.clamp_range); // [A]
+  status_text.print(F(";"));
+  status_text.print(settings.zero_offset); // [adc]
+  status_text.print(F(";"));
+  status_text.print(settings.peak_count);
+  status_text.print(F(";"));
+  Serial.println(status_text.c_str());
 }
 
 void print_device_status() {
   if (status_print_delay.delay_time_is_up(10000)) {
-    float current = get_amps_from_clamp();
-    String status_string = "LOG;CURRENT_LOGGER_RUNNING;";
-    status_string += current;
-    status_string += ";";
-    Serial.println(status_string);
+    send_device_status();
   }
 }
 
-bool current_is_over_threshold(float current) {
-  const float cycle_start_threshold = 35.0; // [A]
-  const float cycle_stop_threshold = 5; // [A]
+void apply_settings() {
+  const Logger_settings &settings = logger_config.get_settings();
+  current_conversion.set_scale(make_fixed_point_scale(settings.clamp_range * 100.0 / 1024, 1023));
+  current_conversion.set_zero_offset(settings.zero_offset);
+  // The cycle is detected on raw adc values, the current is converted only when logged:
+  cycle_start_adc_value = current_conversion.get_adc_value(settings.start_threshold + 1); // first value over it
+  cycle_stop_adc_value = current_conversion.get_adc_value(settings.stop_threshold);
+  current_peaks.set_size(settings.peak_count);
+}
+
+// SERIAL COMMANDS -------------------------------------------------------------
+// CONFIG;<KEY>;<value>; (see logger_config.h), answered with
+// LOG;CONFIG_ACCEPTED; or LOG;CONFIG_REJECTED; and the status line.
+// Accepted settings are applied when no stroke runs, answered with
+// LOG;CONFIG_APPLIED; and the status line
+
+void read_serial_commands() {
+  static Small_string<40> command_text;
+  while (Serial.available()) {
+    char c = Serial.read();
+    if (c != '\r' && c != '\n') {
+      command_text.print(c);
+      continue;
+    }
+    if (!command_text.length()) {
+      continue;
+    }
+    if (!command_text.is_truncated() && logger_config.handle_command(command_text.c_str())) {
+      Serial.println(F("LOG;CONFIG_ACCEPTED;"));
+    } else {
+      Serial.println(F("LOG;CONFIG_REJECTED;"));
+    }
+    send_device_status();
+    command_text.clear();
+  }
+}
+
+// New thresholds and a new peak count (clears the peaks) would corrupt a running stroke:
+void apply_pending_settings() {
+  if (!logger_config.has_pending_settings() || current_capture.is_capturing() || current_peaks.get_count() > 0) {
+    return;
+  }
+  logger_config.apply_pending_settings();
+  apply_settings();
+  Serial.println(F("LOG;CONFIG_APPLIED;"));
+  send_device_status();
+}
+
+bool current_is_over_threshold(int adc_value) {
   static bool current_is_over_threshold = false;
 
-  if (current > cycle_start_threshold) {
+  if (adc_value >= cycle_start_adc_value) {
     current_is_over_threshold = true;
   }
 
-  if (current < cycle_stop_threshold) {
+  if (adc_value < cycle_stop_adc_value) {
     current_is_over_threshold = false;
   }
   return current_is_over_threshold;
@@ -55,38 +144,69 @@ bool current_is_over_threshold(float current) {
 // Start monitoring when current exceeds threshold
 // Log max current once when current falls below threshold
 // The logged current is the smallest value of the 5 biggest measurements
-
-void log_current(float current) {
-  String prefix = "LOG;CURRENT_MAX;";
-  String suffix = ";";
-  Serial.println(prefix + current + suffix); // [A]
+// Charge, estimated energy and duration of the stroke are logged with it:
+// LOG;CURRENT_MAX;<current [A]>;<charge [As]>;<energy [J]>;<duration [s]>;
+// The charge is the mean current times the duration, the mean is converted
+// once per stroke (exact for a linear conversion)
+
+void log_current(long current, unsigned long adc_sum, unsigned long no_of_samples) {
+  long duration = no_of_samples * 1000UL / current_sample_rate; // [ms]
+  int mean_adc_value = (adc_sum + no_of_samples / 2) / no_of_samples;
+  long charge = current_conversion.convert(mean_adc_value) * duration / 1000; // [0.01As]
+
+  Small_string<64> log_text;
+  log_text.print(F("LOG;CURRENT_MAX;"));
+  log_text.print_fixed(current, 2); // [A]
+  log_text.print(F(";"));
+  log_text.print_fixed(charge, 2); // [As]
+  log_text.print(F(";"));
+  log_text.print_fixed(charge * nominal_battery_voltage, 2); // [J]
+  log_text.print(F(";"));
+  log_text.print_fixed(duration, 3); // [s]
+  log_text.print(F(";"));
+  Serial.println(log_text.c_str());
 }
 
-void log_max_current() {
-
-  float current = get_amps_from_clamp();
+void log_max_current(int adc_value, bool is_over_threshold) {
 
   // Store measurements:
-  if (current_is_over_threshold(current)) {
-    // Store first measurement:
-    if (isnan(currents_median_cache.getLowest())) {
-      currents_median_cache.add(current);
-      // Store bigger values:
-    } else if (current > currents_median_cache.getLowest()) {
-      currents_median_cache.add(current);
-    }
+  if (is_over_threshold) {
+    current_peaks.add(adc_value);
+    stroke_adc_sum += adc_value;
+    stroke_no_of_samples++;
     // Log current and clear all values after tool-cycle is completed:
-  } else if (currents_median_cache.getCount() > 0) {
-    log_current(currents_median_cache.getMedian());
-    currents_median_cache.clear(); // Sets current-count to 0 and values to nans
+  } else if (current_peaks.get_count() > 0) {
+    log_current(current_conversion.convert(current_peaks.get_lowest()), stroke_adc_sum, stroke_no_of_samples);
+    current_peaks.clear();
+    stroke_adc_sum = 0;
+    stroke_no_of_samples = 0;
   }
 }
 
+// Every sample is evaluated, the detection runs at the sample rate, not at the loop rate:
+void process_current_samples() {
+  int adc_values[TIMED_SAMPLER_BLOCK_SIZE];
+  current_sampler.update();
+  while (current_sampler.read_block(adc_values)) {
+    for (byte i = 0; i < TIMED_SAMPLER_BLOCK_SIZE; i++) {
+      bool is_over_threshold = current_is_over_threshold(adc_values[i]);
+      log_max_current(adc_values[i], is_over_threshold);
+      current_capture.add_sample(adc_values[i], is_over_threshold);
+    }
+    last_adc_value = adc_values[TIMED_SAMPLER_BLOCK_SIZE - 1];
+  }
+  current_capture.send_report(Serial, current_conversion);
+}
+
 // SETUP -----------------------------------------------------------------------
 
 void setup() {
 
+  current_conversion.load_calibration();
+  logger_config.load();
+  apply_settings();
   Serial.begin(115200);
+  current_sampler.begin();
   Serial.println("EXIT SETUP");
 }
 
@@ -96,8 +216,13 @@ void loop() {
 
   print_device_status();
 
-  log_max_current();
+  read_serial_commands();
+
+  apply_pending_settings();
+
+  logger_config.update(); // stores the applied settings byte by byte
+
+  process_current_samples();
 
-  // delayMicroseconds(100); // reduce number of measurments
-  //Serial.println(get_amps_from_clamp(), 2); // For debug and calibration
+  //Serial.println(current_conversion.convert(last_adc_value)); // For debug and calibration [0.01A]
 }
\ No newline at end of file
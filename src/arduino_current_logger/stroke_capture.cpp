@@ -0,0 +1,207 @@
+/*******************************************************************************
+ * stroke_capture.cpp **********************************************************
+ *******************************************************************************/
+
+#include "stroke_capture.h"
+#include <common/small_string.h>
+
+const byte max_curve_line_length = 56; // fits into the TX buffer of 64 bytes with the line end
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Stroke_capture::Stroke_capture(byte samples_per_point, unsigned int point_interval) {
+  _samples_per_point = max(samples_per_point, byte(1));
+  _point_interval = point_interval;
+  _point_max = 0;
+  _point_count = 0;
+  _pre_trigger_head = 0;
+  _no_of_pre_trigger_points = 0;
+  _state = waiting_for_trigger;
+  _data_length = 0;
+  _last_stored_point = 0;
+  _no_of_stored_points = 0;
+  _no_of_stroke_points = 0;
+  _stroke_pre_trigger_points = 0;
+  _tail_countdown = 0;
+  _is_truncated = false;
+  _report_is_pending = false;
+  _header_is_sent = false;
+  _read_position = 0;
+  _next_report_point = 0;
+  _last_read_point = 0;
+  _last_sent_current = 0;
+  _no_of_dropped_reports = 0;
+}
+
+// CAPTURE ---------------------------------------------------------------------
+void Stroke_capture::add_sample(int adc_value, bool is_over_threshold) {
+  _point_max = _point_count ? max(_point_max, adc_value) : adc_value;
+  if (++_point_count < _samples_per_point) {
+    return;
+  }
+  _point_count = 0;
+  add_point(_point_max, is_over_threshold);
+}
+
+void Stroke_capture::add_point(int point, bool is_over_threshold) {
+  if (_state == waiting_for_trigger) {
+    if (!is_over_threshold) {
+      _pre_trigger_points[_pre_trigger_head] = point;
+      _pre_trigger_head = (_pre_trigger_head + 1) % STROKE_CAPTURE_PRE_TRIGGER;
+      _no_of_pre_trigger_points = min(byte(_no_of_pre_trigger_points + 1), byte(STROKE_CAPTURE_PRE_TRIGGER));
+      return;
+    }
+    start_stroke();
+  }
+
+  store_point(point);
+
+  if (is_over_threshold) {
+    _state = capturing;
+    _tail_countdown = STROKE_CAPTURE_TAIL;
+  } else {
+    _state = capturing_tail;
+    if (--_tail_countdown == 0) {
+      _state = waiting_for_trigger;
+      _no_of_pre_trigger_points = 0;
+      _report_is_pending = true;
+    }
+  }
+}
+
+void Stroke_capture::start_stroke() {
+  if (_report_is_pending) {
+    _no_of_dropped_reports++; // the previous stroke has not been sent yet
+  }
+  _report_is_pending = false;
+  _header_is_sent = false;
+  _data_length = 0;
+  _last_stored_point = 0;
+  _no_of_stored_points = 0;
+  _no_of_stroke_points = 0;
+  _is_truncated = false;
+
+  // Store the pre trigger points, oldest first:
+  _stroke_pre_trigger_points = _no_of_pre_trigger_points;
+  byte index = _pre_trigger_head + STROKE_CAPTURE_PRE_TRIGGER - _no_of_pre_trigger_points;
+  index %= STROKE_CAPTURE_PRE_TRIGGER;
+  for (byte i = 0; i < _no_of_pre_trigger_points; i++) {
+    store_point(_pre_trigger_points[index]);
+    index = (index + 1) % STROKE_CAPTURE_PRE_TRIGGER;
+  }
+  _state = capturing;
+}
+
+// Zigzag varint: the sign goes to bit 0, 7 bits per byte, bit 7 marks a following byte:
+void Stroke_capture::store_point(int point) {
+  _no_of_stroke_points++;
+  if (_is_truncated) {
+    return;
+  }
+  int delta = point - _last_stored_point;
+  unsigned int zigzag = (unsigned int)(delta << 1) ^ (unsigned int)(delta >> 15);
+  byte length = zigzag < 0x80 ? 1 : zigzag < 0x4000 ? 2 : 3;
+  if (_data_length + length > STROKE_CAPTURE_SIZE) {
+    _is_truncated = true;
+    return;
+  }
+  while (zigzag >= 0x80) {
+    _data[_data_length++] = byte(zigzag) | 0x80;
+    zigzag >>= 7;
+  }
+  _data[_data_length++] = byte(zigzag);
+  _last_stored_point = point;
+  _no_of_stored_points++;
+}
+
+int Stroke_capture::read_point(unsigned int &position, int last_point) {
+  unsigned int zigzag = 0;
+  byte shift = 0;
+  byte data;
+  do {
+    data = _data[position++];
+    zigzag |= (unsigned int)(data & 0x7F) << shift;
+    shift += 7;
+  } while (data & 0x80);
+  int delta = int(zigzag >> 1) ^ -int(zigzag & 1);
+  return last_point + delta;
+}
+
+// REPORT ----------------------------------------------------------------------
+void Stroke_capture::send_report(HardwareSerial &port, Sensor_conversion &conversion) {
+  if (!_report_is_pending) {
+    return;
+  }
+  Small_string<64> line;
+
+  if (!_header_is_sent) {
+    line.print("LOG;CURRENT_STROKE;");
+    line.print(_no_of_stored_points);
+    line.print(";");
+    line.print(_no_of_stroke_points);
+    line.print(";");
+    line.print(_point_interval);
+    line.print(";");
+    line.print(_stroke_pre_trigger_points);
+    line.print(";");
+    line.print(_is_truncated ? 1 : 0);
+    line.print(";\r\n");
+    if (port.availableForWrite() < line.length()) {
+      return;
+    }
+    port.print(line.c_str());
+    _header_is_sent = true;
+    _read_position = 0;
+    _next_report_point = 0;
+    _last_read_point = 0;
+    _last_sent_current = 0;
+    return;
+  }
+
+  line.print("LOG;CURRENT_CURVE;");
+  line.print(_next_report_point);
+  line.print(";");
+  unsigned int position = _read_position;
+  unsigned int point_index = _next_report_point;
+  int last_read_point = _last_read_point;
+  long last_sent_current = _last_sent_current;
+  while (point_index < _no_of_stored_points) {
+    unsigned int next_position = position;
+    int point = read_point(next_position, last_read_point);
+    long current = conversion.convert(point);
+    Small_string<8> delta;
+    if (point_index != _next_report_point) {
+      delta.print(",");
+    }
+    delta.print(current - last_sent_current);
+    if (line.length() + delta.length() > max_curve_line_length) {
+      break;
+    }
+    line.print(delta.c_str());
+    position = next_position;
+    last_read_point = point;
+    last_sent_current = current;
+    point_index++;
+  }
+  line.print(";\r\n");
+  if (port.availableForWrite() < line.length()) {
+    return;
+  }
+  port.print(line.c_str());
+  _read_position = position;
+  _next_report_point = point_index;
+  _last_read_point = last_read_point;
+  _last_sent_current = last_sent_current;
+  if (_next_report_point >= _no_of_stored_points) {
+    _report_is_pending = false;
+    _header_is_sent = false;
+  }
+}
+
+// GETTER ----------------------------------------------------------------------
+bool Stroke_capture::is_capturing() { return _state != waiting_for_trigger; }
+
+bool Stroke_capture::is_truncated() { return _is_truncated; }
+
+unsigned int Stroke_capture::get_no_of_stored_points() { return _no_of_stored_points; }
+
+unsigned int Stroke_capture::get_no_of_dropped_reports() { return _no_of_dropped_reports; }
@@ -0,0 +1,90 @@
+/* *****************************************************************************
+ * stroke_capture.h ************************************************************
+ * *****************************************************************************
+ * Captures the current curve of a whole tool stroke, including the inrush
+ * before the cycle threshold trips, and sends it after the stroke.
+ *
+ * Every point is the biggest of samples_per_point samples, so a short inrush
+ * peak keeps its height.
+ * While no stroke runs, the last STROKE_CAPTURE_PRE_TRIGGER points are kept
+ * in a ring buffer. When the threshold trips, these points and all following
+ * points are stored until STROKE_CAPTURE_TAIL points after the threshold has
+ * fallen again. The points are stored as zigzag varint deltas of the raw ADC
+ * values (one byte for a change of up to 63, two bytes otherwise), so the
+ * STROKE_CAPTURE_SIZE bytes hold 384 to 768 points. If the buffer is full,
+ * the rest of the stroke is only counted and the capture is truncated.
+ *
+ * send_report() sends the stroke in complete lines that fit into the free TX
+ * buffer, so it never blocks the loop. The points are converted to [0.01A]:
+ * LOG;CURRENT_STROKE;<stored points>;<stroke points>;<interval>;<pre trigger points>;<truncated>;
+ * LOG;CURRENT_CURVE;<index of the first point>;<delta>,<delta>,...;
+ * The first delta of the curve is relative to 0, the interval is in [ms].
+ * A stroke that starts before the report is sent replaces the report.
+ * *****************************************************************************
+ */
+
+#ifndef STROKECAPTURE_H
+#define STROKECAPTURE_H
+
+#include <Arduino.h>
+#include <common/sensor_conversion.h>
+
+#define STROKE_CAPTURE_SIZE 768 // [bytes] of varint deltas
+#define STROKE_CAPTURE_PRE_TRIGGER 32 // [points]
+#define STROKE_CAPTURE_TAIL 32 // [points]
+
+class Stroke_capture {
+
+public:
+  // FUNCTIONS:
+  Stroke_capture(byte samples_per_point, unsigned int point_interval); // [ms]
+
+  void add_sample(int adc_value, bool is_over_threshold);
+  void send_report(HardwareSerial &port, Sensor_conversion &conversion);
+
+  // GETTER:
+  bool is_capturing();
+  bool is_truncated();
+  unsigned int get_no_of_stored_points();
+  unsigned int get_no_of_dropped_reports();
+
+private:
+  // VARIABLES:
+  byte _samples_per_point;
+  unsigned int _point_interval;
+  int _point_max; // [adc]
+  byte _point_count;
+
+  // Pre trigger ring buffer:
+  int _pre_trigger_points[STROKE_CAPTURE_PRE_TRIGGER];
+  byte _pre_trigger_head;
+  byte _no_of_pre_trigger_points;
+
+  // Stroke:
+  enum Capture_state { waiting_for_trigger, capturing, capturing_tail, end_of_capture_state_enum };
+  byte _state;
+  byte _data[STROKE_CAPTURE_SIZE];
+  unsigned int _data_length;
+  int _last_stored_point;
+  unsigned int _no_of_stored_points;
+  unsigned int _no_of_stroke_points; // also counts the points that did not fit
+  byte _stroke_pre_trigger_points;
+  byte _tail_countdown;
+  bool _is_truncated;
+
+  // Report:
+  bool _report_is_pending;
+  bool _header_is_sent;
+  unsigned int _read_position;
+  unsigned int _next_report_point;
+  int _last_read_point; // [adc]
+  long _last_sent_current; // [0.01A]
+  unsigned int _no_of_dropped_reports;
+
+  // FUNCTIONS:
+  void add_point(int point, bool is_over_threshold);
+  void start_stroke();
+  void store_point(int point);
+  int read_point(unsigned int &position, int last_point);
+};
+#endif
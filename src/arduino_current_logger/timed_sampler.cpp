@@ -0,0 +1,107 @@
+/*******************************************************************************
+ * timed_sampler.cpp ***********************************************************
+ *******************************************************************************/
+
+#include "timed_sampler.h"
+
+Timed_sampler *Timed_sampler::active_instance = 0;
+
+// INTERRUPT SERVICE ROUTINE ---------------------------------------------------
+#ifdef __AVR__
+ISR(ADC_vect) {
+  TIFR1 = (1 << OCF1B); // the flag triggers the next conversion, it is not cleared by an interrupt
+  if (Timed_sampler::active_instance) {
+    Timed_sampler::active_instance->store_value(ADC);
+  }
+}
+#endif
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Timed_sampler::Timed_sampler(byte pin, unsigned int sample_rate) {
+  _pin = pin;
+  _sample_rate = max(sample_rate, 31U); // slowest rate of timer1 with prescaler 8
+  _no_of_blocks = 0;
+  _head_block = 0;
+  _head_index = 0;
+  _tail_block = 0;
+  _lost_values = 0;
+#ifndef __AVR__
+  _next_sample_micros = 0;
+#endif
+}
+
+// SETUP -----------------------------------------------------------------------
+void Timed_sampler::begin() {
+  active_instance = this;
+
+#ifdef __AVR__
+  byte adc_channel = _pin >= A0 ? _pin - A0 : _pin;
+  noInterrupts();
+  // Timer1 CTC mode (TOP = OCR1A), prescaler 8 (2MHz):
+  TCCR1A = 0;
+  TCCR1B = (1 << WGM12) | (1 << CS11);
+  TCNT1 = 0;
+  OCR1A = 2000000UL / _sample_rate - 1;
+  OCR1B = OCR1A;
+  TIFR1 = (1 << OCF1B);
+  // Trigger source timer1 compare match B:
+  ADCSRB = (1 << ADTS2) | (1 << ADTS0);
+  ADMUX = (1 << REFS0) | (adc_channel & 0x07); // AVCC reference like analogRead()
+  // Enable, auto trigger, interrupt, prescaler 128:
+  ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+  interrupts();
+#else
+  _next_sample_micros = micros();
+#endif
+}
+
+// SAMPLE INPUT (PRODUCER) -----------------------------------------------------
+void Timed_sampler::store_value(unsigned int value) {
+  byte block = _head_block; // never the block being read, one block stays free
+  _values[block][_head_index] = value;
+  if (++_head_index < TIMED_SAMPLER_BLOCK_SIZE) {
+    return;
+  }
+  byte next_block = (block + 1) & (TIMED_SAMPLER_NO_OF_BLOCKS - 1);
+  if (next_block == _tail_block) {
+    _lost_values += TIMED_SAMPLER_BLOCK_SIZE; // buffer full, the block is overwritten
+    _head_index = 0;
+    return;
+  }
+  _head_block = next_block;
+  _head_index = 0;
+}
+
+void Timed_sampler::update() {
+#ifndef __AVR__
+  while (long(micros() - _next_sample_micros) >= 0) {
+    store_value(analogRead(_pin));
+    _next_sample_micros += 1000000UL / _sample_rate;
+  }
+#endif
+}
+
+// READ VALUES (CONSUMER) ------------------------------------------------------
+bool Timed_sampler::read_block(int *values) {
+  if (_tail_block == _head_block) {
+    return false;
+  }
+  for (byte i = 0; i < TIMED_SAMPLER_BLOCK_SIZE; i++) {
+    values[i] = _values[_tail_block][i];
+  }
+  _tail_block = (_tail_block + 1) & (TIMED_SAMPLER_NO_OF_BLOCKS - 1);
+  _no_of_blocks++;
+  return true;
+}
+
+// GETTER ----------------------------------------------------------------------
+unsigned int Timed_sampler::get_sample_rate() { return _sample_rate; }
+
+unsigned long Timed_sampler::get_no_of_blocks() { return _no_of_blocks; }
+
+unsigned int Timed_sampler::get_lost_values() {
+  noInterrupts();
+  unsigned int lost_values = _lost_values;
+  interrupts();
+  return lost_values;
+}
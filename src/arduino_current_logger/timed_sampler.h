@@ -0,0 +1,67 @@
+/* *****************************************************************************
+ * timed_sampler.h *************************************************************
+ * *****************************************************************************
+ * Samples one analog input at a fixed, configurable sample rate and hands the
+ * values to the loop in blocks of TIMED_SAMPLER_BLOCK_SIZE values.
+ *
+ * The interrupt fills a ring buffer of TIMED_SAMPLER_NO_OF_BLOCKS blocks,
+ * read_block() copies the oldest full block. If the loop does not keep up,
+ * the values that do not fit into the buffer are counted as lost, the
+ * sample rate of the delivered blocks never changes.
+ *
+ * ATMEGA328 (ARDUINO NANO):
+ * - Timer1 runs in CTC mode, its compare match B triggers every conversion,
+ *   the ADC interrupt stores the result. The ADC clock is 16MHz/128, one
+ *   conversion takes 104us, the sample rate must stay below 9000Hz.
+ * - Timer1 is used, analogRead() must not be used while the sampler runs.
+ *
+ * OTHER PLATFORMS:
+ * - update() reads the input with analogRead() whenever a sample is due.
+ * *****************************************************************************
+ */
+
+#ifndef TIMEDSAMPLER_H
+#define TIMEDSAMPLER_H
+
+#include <Arduino.h>
+
+#define TIMED_SAMPLER_BLOCK_SIZE 32
+#define TIMED_SAMPLER_NO_OF_BLOCKS 4 // must be a power of two
+
+class Timed_sampler {
+
+public:
+  // FUNCTIONS:
+  Timed_sampler(byte pin, unsigned int sample_rate); // [Hz]
+
+  void begin();
+  void update();
+  bool read_block(int *values); // copies TIMED_SAMPLER_BLOCK_SIZE values
+
+  unsigned int get_sample_rate();
+  unsigned long get_no_of_blocks();
+  unsigned int get_lost_values();
+
+  // Called by the interrupt service routine:
+  void store_value(unsigned int value);
+  static Timed_sampler *active_instance;
+
+private:
+  // VARIABLES:
+  byte _pin;
+  unsigned int _sample_rate;
+  unsigned long _no_of_blocks;
+#ifndef __AVR__
+  unsigned long _next_sample_micros;
+#endif
+
+  // Written by the interrupt:
+  volatile unsigned int _values[TIMED_SAMPLER_NO_OF_BLOCKS][TIMED_SAMPLER_BLOCK_SIZE];
+  volatile byte _head_block;
+  volatile byte _head_index;
+  volatile unsigned int _lost_values;
+
+  // Written by the loop:
+  volatile byte _tail_block;
+};
+#endif
@@ -0,0 +1,28 @@
+/*******************************************************************************
+ * heap_monitor.cpp ************************************************************
+ *******************************************************************************/
+
+#include "heap_monitor.h"
+#include <stddef.h>
+
+static unsigned long heap_allocation_count = 0;
+
+unsigned long get_heap_allocation_count() { return heap_allocation_count; }
+
+#ifdef HEAP_MONITOR
+// The linker redirects all calls of malloc and realloc to these wrappers:
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+void *__wrap_malloc(size_t size) {
+  heap_allocation_count++;
+  return __real_malloc(size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+  heap_allocation_count++;
+  return __real_realloc(pointer, size);
+}
+}
+#endif
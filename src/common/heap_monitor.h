@@ -0,0 +1,18 @@
+/* *****************************************************************************
+ * heap_monitor.h **************************************************************
+ * *****************************************************************************
+ * Counts the heap allocations (malloc and realloc) since startup.
+ * Once the machine runs, the count should not increase any more.
+ *
+ * Needs these build flags, set in platformio.ini:
+ * -D HEAP_MONITOR -Wl,--wrap=malloc -Wl,--wrap=realloc
+ * Without HEAP_MONITOR the count stays 0.
+ * *****************************************************************************
+ */
+
+#ifndef HEAPMONITOR_H
+#define HEAPMONITOR_H
+
+unsigned long get_heap_allocation_count();
+
+#endif
@@ -0,0 +1,40 @@
+/*******************************************************************************
+ * peak_tracker.cpp ************************************************************
+ *******************************************************************************/
+
+#include "peak_tracker.h"
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Peak_tracker::Peak_tracker(byte size) {
+  _count = 0;
+  set_size(size);
+}
+
+// VALUES ----------------------------------------------------------------------
+void Peak_tracker::add(int value) {
+  if (_count == _size && value <= _values[_size - 1]) {
+    return;
+  }
+  byte index = _count < _size ? _count++ : _size - 1; // the smallest value drops out
+  while (index > 0 && _values[index - 1] < value) {
+    _values[index] = _values[index - 1];
+    index--;
+  }
+  _values[index] = value;
+}
+
+void Peak_tracker::clear() { _count = 0; }
+
+void Peak_tracker::set_size(byte size) {
+  _size = min(max(size, byte(1)), byte(PEAK_TRACKER_MAX_SIZE));
+  _count = 0;
+}
+
+// GETTER ----------------------------------------------------------------------
+int Peak_tracker::get_lowest() { return _count ? _values[_count - 1] : 0; }
+
+int Peak_tracker::get_highest() { return _count ? _values[0] : 0; }
+
+byte Peak_tracker::get_count() { return _count; }
+
+byte Peak_tracker::get_size() { return _size; }
@@ -0,0 +1,47 @@
+/* *****************************************************************************
+ * peak_tracker.h **************************************************************
+ * *****************************************************************************
+ * Keeps the size biggest values added since the last clear(), the size can
+ * be changed at runtime up to PEAK_TRACKER_MAX_SIZE.
+ *
+ * get_lowest() returns the smallest of these values, a peak that ignores up
+ * to size - 1 spikes. The values are integers (raw ADC values),
+ * they are converted to engineering units only when the peak is reported.
+ *
+ * The values are kept sorted, biggest first. A value that is not bigger than
+ * the smallest stored value (almost every value of a signal) is rejected by
+ * one comparison, a bigger value is inserted by shifting at most size
+ * values. All getters are O(1).
+ * *****************************************************************************
+ */
+
+#ifndef PEAKTRACKER_H
+#define PEAKTRACKER_H
+
+#include <Arduino.h>
+
+#define PEAK_TRACKER_MAX_SIZE 8
+
+class Peak_tracker {
+
+public:
+  // FUNCTIONS:
+  Peak_tracker(byte size);
+
+  void add(int value);
+  void clear();
+  void set_size(byte size); // clears the values
+
+  // GETTER:
+  int get_lowest(); // smallest of the biggest values, 0 if empty
+  int get_highest();
+  byte get_count();
+  byte get_size();
+
+private:
+  // VARIABLES:
+  int _values[PEAK_TRACKER_MAX_SIZE]; // biggest first
+  byte _size;
+  byte _count;
+};
+#endif
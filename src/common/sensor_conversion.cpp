@@ -0,0 +1,129 @@
+/*******************************************************************************
+ * sensor_conversion.cpp *******************************************************
+ *******************************************************************************/
+
+#include "sensor_conversion.h"
+#include <EEPROM.h>
+
+const byte calibration_magic = 'C';
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Sensor_conversion::Sensor_conversion(Fixed_point_scale scale, int eeprom_address) {
+  _scale = scale;
+  _zero_offset = 0;
+  _eeprom_address = eeprom_address;
+  _no_of_points = 0;
+}
+
+// CONVERSION ------------------------------------------------------------------
+long Sensor_conversion::convert(int adc_value) {
+  if (_no_of_points) {
+    return interpolate(adc_value);
+  }
+  return (long(adc_value - _zero_offset) * _scale.factor) >> _scale.shift;
+}
+
+long Sensor_conversion::interpolate(int adc_value) {
+  byte segment = 0; // from point n to point n+1
+  while (segment < _no_of_points - 2 && adc_value > _points[segment + 1].adc_value) {
+    segment++;
+  }
+  const Calibration_point &start = _points[segment];
+  const Calibration_point &end = _points[segment + 1];
+  return start.value + long(adc_value - start.adc_value) * (end.value - start.value) /
+                           (end.adc_value - start.adc_value);
+}
+
+// Smallest adc value [0-1023] that reaches the value, for a rising conversion.
+// Lets a threshold be compared with raw adc values:
+int Sensor_conversion::get_adc_value(long value) {
+  int low = 0;
+  int high = 1023;
+  while (low < high) {
+    int middle = (low + high) / 2;
+    if (convert(middle) >= value) {
+      high = middle;
+    } else {
+      low = middle + 1;
+    }
+  }
+  return low;
+}
+
+// LINEAR CONVERSION -----------------------------------------------------------
+void Sensor_conversion::set_scale(Fixed_point_scale scale) { _scale = scale; }
+
+void Sensor_conversion::set_zero_offset(int zero_offset) { _zero_offset = zero_offset; }
+
+// CALIBRATION -----------------------------------------------------------------
+void Sensor_conversion::load_calibration() {
+  _no_of_points = 0;
+  if (EEPROM.read(_eeprom_address) != calibration_magic) {
+    return;
+  }
+  byte no_of_points = EEPROM.read(_eeprom_address + 1);
+  if (no_of_points < 2 || no_of_points > SENSOR_CONVERSION_MAX_POINTS) {
+    return;
+  }
+  Calibration_point points[SENSOR_CONVERSION_MAX_POINTS];
+  byte *bytes = reinterpret_cast<byte *>(points);
+  for (byte i = 0; i < no_of_points * sizeof(Calibration_point); i++) {
+    bytes[i] = EEPROM.read(_eeprom_address + 2 + i);
+  }
+  byte checksum = EEPROM.read(_eeprom_address + 2 + SENSOR_CONVERSION_MAX_POINTS * sizeof(Calibration_point));
+  if (checksum != calculate_checksum(points, no_of_points) || !points_are_valid(points, no_of_points)) {
+    return;
+  }
+  memcpy(_points, points, sizeof(points));
+  _no_of_points = no_of_points;
+}
+
+bool Sensor_conversion::store_calibration(const Calibration_point *points, byte no_of_points) {
+  if (!points_are_valid(points, no_of_points)) {
+    return false;
+  }
+  EEPROM.update(_eeprom_address, calibration_magic);
+  EEPROM.update(_eeprom_address + 1, no_of_points);
+  const byte *bytes = reinterpret_cast<const byte *>(points);
+  for (byte i = 0; i < no_of_points * sizeof(Calibration_point); i++) {
+    EEPROM.update(_eeprom_address + 2 + i, bytes[i]);
+  }
+  EEPROM.update(_eeprom_address + 2 + SENSOR_CONVERSION_MAX_POINTS * sizeof(Calibration_point),
+                calculate_checksum(points, no_of_points));
+  load_calibration();
+  return _no_of_points == no_of_points;
+}
+
+void Sensor_conversion::clear_calibration() {
+  EEPROM.update(_eeprom_address, 0xFF);
+  _no_of_points = 0;
+}
+
+// The adc values must rise, at least two points are needed:
+bool Sensor_conversion::points_are_valid(const Calibration_point *points, byte no_of_points) {
+  if (no_of_points < 2 || no_of_points > SENSOR_CONVERSION_MAX_POINTS) {
+    return false;
+  }
+  for (byte i = 1; i < no_of_points; i++) {
+    if (points[i].adc_value <= points[i - 1].adc_value) {
+      return false;
+    }
+  }
+  return true;
+}
+
+byte Sensor_conversion::calculate_checksum(const Calibration_point *points, byte no_of_points) {
+  const byte *bytes = reinterpret_cast<const byte *>(points);
+  byte checksum = no_of_points;
+  for (byte i = 0; i < no_of_points * sizeof(Calibration_point); i++) {
+    checksum = (checksum << 1 | checksum >> 7) ^ bytes[i]; // rotate and xor
+  }
+  return checksum;
+}
+
+// GETTER ----------------------------------------------------------------------
+bool Sensor_conversion::is_calibrated() { return _no_of_points > 0; }
+
+Fixed_point_scale Sensor_conversion::get_scale() { return _scale; }
+
+int Sensor_conversion::get_zero_offset() { return _zero_offset; }
@@ -0,0 +1,96 @@
+/* *****************************************************************************
+ * sensor_conversion.h *********************************************************
+ * *****************************************************************************
+ * Converts ADC values to integer engineering units without float math.
+ *
+ * LINEAR CONVERSION:
+ * The scale (units per ADC step) is turned into a fixed point factor at
+ * compile time, make_fixed_point_scale() uses the biggest shift that keeps
+ * max_input * factor within a signed long:
+ *   constexpr Fixed_point_scale force_scale = make_fixed_point_scale(45.24, 1023);
+ *   value = (adc * factor) >> shift
+ * The result is rounded down like int() of the float calculation, it differs
+ * from the float reference by at most one unit.
+ * set_scale() and set_zero_offset() (ADC value of 0 units, subtracted before
+ * the scaling) change the linear conversion at runtime.
+ *
+ * CALIBRATION:
+ * Optionally a sensor gets a piecewise linear calibration table of 2 to
+ * SENSOR_CONVERSION_MAX_POINTS points {adc value, engineering value},
+ * stored in EEPROM at the address of the sensor. If a valid table is found,
+ * it replaces the linear conversion, outside of the table the first or last
+ * segment is extrapolated.
+ * get_adc_value() converts a threshold back to an ADC value (binary search,
+ * the conversion must rise), so it can be compared with raw values.
+ * EEPROM LAYOUT (SENSOR_CONVERSION_EEPROM_SIZE bytes):
+ * magic 'C', number of points, points (int adc, int value), checksum
+ * *****************************************************************************
+ */
+
+#ifndef SENSORCONVERSION_H
+#define SENSORCONVERSION_H
+
+#include <Arduino.h>
+
+#define SENSOR_CONVERSION_MAX_POINTS 8
+#define SENSOR_CONVERSION_EEPROM_SIZE (3 + SENSOR_CONVERSION_MAX_POINTS * 4)
+
+struct Fixed_point_scale {
+  long factor;
+  byte shift;
+};
+
+struct Calibration_point {
+  int adc_value;
+  int value;
+};
+
+// COMPILE TIME SCALE ----------------------------------------------------------
+constexpr long fixed_point_factor(double scale, byte shift) { return long(scale * double(1UL << shift) + 0.5); }
+
+constexpr byte fixed_point_shift(double scale, unsigned int max_input, byte shift) {
+  return (shift == 0 || double(max_input) * double(fixed_point_factor(scale, shift)) < 2147483647.0)
+             ? shift
+             : fixed_point_shift(scale, max_input, shift - 1);
+}
+
+constexpr Fixed_point_scale make_fixed_point_scale(double scale, unsigned int max_input) {
+  return Fixed_point_scale{fixed_point_factor(scale, fixed_point_shift(scale, max_input, 24)),
+                           fixed_point_shift(scale, max_input, 24)};
+}
+
+class Sensor_conversion {
+
+public:
+  // FUNCTIONS:
+  Sensor_conversion(Fixed_point_scale scale, int eeprom_address);
+
+  long convert(int adc_value);
+  int get_adc_value(long value); // inverse of convert()
+
+  void load_calibration();
+  bool store_calibration(const Calibration_point *points, byte no_of_points);
+  void clear_calibration();
+
+  void set_scale(Fixed_point_scale scale);
+  void set_zero_offset(int zero_offset); // [adc], linear conversion only
+
+  // GETTER:
+  bool is_calibrated();
+  Fixed_point_scale get_scale();
+  int get_zero_offset();
+
+private:
+  // VARIABLES:
+  Fixed_point_scale _scale;
+  int _zero_offset;
+  int _eeprom_address;
+  byte _no_of_points; // 0 = not calibrated
+  Calibration_point _points[SENSOR_CONVERSION_MAX_POINTS];
+
+  // FUNCTIONS:
+  bool points_are_valid(const Calibration_point *points, byte no_of_points);
+  byte calculate_checksum(const Calibration_point *points, byte no_of_points);
+  long interpolate(int adc_value);
+};
+#endif
@@ -0,0 +1,79 @@
+/* *****************************************************************************
+ * small_string.h **************************************************************
+ * *****************************************************************************
+ * Fixed size text buffer on the stack, formatted with the Print functions.
+ * Replaces String concatenations in the display and log output, nothing is
+ * allocated on the heap. Text that does not fit is cut off and flagged.
+ *
+ * Small_string<16> text;
+ * text.print(F("t = "));
+ * text.print(temperature);
+ * text.print(F(" C"));
+ * display_text_in_field(text.c_str(), "t10");
+ *
+ * print_fixed() prints integers with a fixed number of decimals,
+ * e.g. print_fixed(1234, 2) prints "12.34".
+ * *****************************************************************************
+ */
+
+#ifndef SMALLSTRING_H
+#define SMALLSTRING_H
+
+#include <Arduino.h>
+
+template <byte SIZE> class Small_string : public Print {
+
+public:
+  // FUNCTIONS:
+  Small_string() { clear(); }
+
+  size_t write(uint8_t c) {
+    if (_length >= SIZE - 1) {
+      _is_truncated = true;
+      return 0;
+    }
+    _text[_length++] = c;
+    _text[_length] = '\0';
+    return 1;
+  }
+  using Print::write;
+
+  size_t print_fixed(long value, byte decimals) {
+    size_t size = 0;
+    if (value < 0) {
+      size += print('-');
+      value = -value;
+    }
+    long divisor = 1;
+    for (byte i = 0; i < decimals; i++) {
+      divisor *= 10;
+    }
+    size += print(value / divisor);
+    if (decimals) {
+      size += print('.');
+      long fraction = value % divisor;
+      for (long digit = divisor / 10; digit > 1 && fraction < digit; digit /= 10) {
+        size += print('0'); // leading zeros of the fraction
+      }
+      size += print(fraction);
+    }
+    return size;
+  }
+
+  void clear() {
+    _length = 0;
+    _text[0] = '\0';
+    _is_truncated = false;
+  }
+
+  const char *c_str() const { return _text; }
+  byte length() const { return _length; }
+  bool is_truncated() const { return _is_truncated; }
+
+private:
+  // VARIABLES:
+  char _text[SIZE];
+  byte _length;
+  bool _is_truncated;
+};
+#endif
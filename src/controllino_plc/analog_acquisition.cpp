@@ -0,0 +1,184 @@
+/*******************************************************************************
+ * analog_acquisition.cpp ******************************************************
+ *******************************************************************************/
+
+#include "analog_acquisition.h"
+
+Analog_acquisition *Analog_acquisition::active_instance = 0;
+
+// INTERRUPT SERVICE ROUTINE ---------------------------------------------------
+#ifdef __AVR__
+ISR(ADC_vect) {
+  if (Analog_acquisition::active_instance) {
+    Analog_acquisition::active_instance->store_conversion(ADC);
+  }
+}
+#endif
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Analog_acquisition::Analog_acquisition() {
+  _no_of_channels = 0;
+  _channel = 0;
+  _no_of_conversions = 0;
+  _running_sum = 0;
+  _skip_conversion = true;
+  _recorded_channel = ANALOG_ACQUISITION_NO_RECORDING;
+  _record_head = 0;
+  _record_tail = 0;
+  _lost_recorded_values = 0;
+  for (byte channel = 0; channel < ANALOG_ACQUISITION_MAX_CHANNELS; channel++) {
+    _isr_sums[channel] = 0;
+    _isr_micros[channel] = 0;
+    _isr_no_of_values[channel] = 0;
+    _sums[channel] = 0;
+    _micros[channel] = 0;
+    _no_of_values[channel] = 0;
+  }
+}
+
+// SETUP -----------------------------------------------------------------------
+// Returns the channel number of the input:
+byte Analog_acquisition::add_input(byte pin) {
+  if (_no_of_channels >= ANALOG_ACQUISITION_MAX_CHANNELS) {
+    return ANALOG_ACQUISITION_MAX_CHANNELS - 1;
+  }
+  _pins[_no_of_channels] = pin;
+  return _no_of_channels++;
+}
+
+void Analog_acquisition::begin() {
+  if (!_no_of_channels) {
+    return;
+  }
+  active_instance = this;
+
+#ifdef __AVR__
+  noInterrupts();
+  ADCSRA = 0;
+  ADCSRB &= ~((1 << ADTS2) | (1 << ADTS1) | (1 << ADTS0)); // free running mode
+  select_channel(0);
+  _skip_conversion = true;
+  // Enable, auto trigger, interrupt, prescaler 128:
+  ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+  ADCSRA |= (1 << ADSC);
+  interrupts();
+#endif
+}
+
+void Analog_acquisition::select_channel(byte channel) {
+#ifdef __AVR__
+  byte pin = _pins[channel];
+  byte adc_channel = pin >= A0 ? pin - A0 : pin;
+#ifdef MUX5
+  if (adc_channel & 0x08) {
+    ADCSRB |= (1 << MUX5);
+  } else {
+    ADCSRB &= ~(1 << MUX5);
+  }
+#endif
+  ADMUX = (1 << REFS0) | (adc_channel & 0x07); // AVCC reference like analogRead()
+#endif
+}
+
+// SAMPLE INPUTS (PRODUCER) ----------------------------------------------------
+void Analog_acquisition::store_conversion(unsigned int result) {
+  // The conversion was started before the channel switch:
+  if (_skip_conversion) {
+    _skip_conversion = false;
+    return;
+  }
+  _running_sum += result;
+  if (++_no_of_conversions < ANALOG_ACQUISITION_OVERSAMPLING) {
+    return;
+  }
+  byte channel = _channel;
+  store_value(channel, _running_sum);
+  _running_sum = 0;
+  _no_of_conversions = 0;
+
+  _channel = (channel + 1) % _no_of_channels;
+  select_channel(_channel);
+  _skip_conversion = true;
+}
+
+void Analog_acquisition::store_value(byte channel, unsigned int sum) {
+  unsigned long now = micros();
+  _isr_sums[channel] = sum;
+  _isr_micros[channel] = now;
+  _isr_no_of_values[channel]++;
+
+  if (channel != _recorded_channel) {
+    return;
+  }
+  byte next_head = (_record_head + 1) & (ANALOG_ACQUISITION_RECORD_SIZE - 1);
+  if (next_head == _record_tail) {
+    _lost_recorded_values++; // buffer full
+    return;
+  }
+  _record_sums[_record_head] = sum;
+  _record_micros[_record_head] = now;
+  _record_head = next_head;
+}
+
+// READ VALUES (CONSUMER) ------------------------------------------------------
+void Analog_acquisition::update() {
+#ifndef __AVR__
+  for (byte channel = 0; channel < _no_of_channels; channel++) {
+    store_value(channel, analogRead(_pins[channel]) * ANALOG_ACQUISITION_OVERSAMPLING);
+  }
+#endif
+  noInterrupts();
+  for (byte channel = 0; channel < _no_of_channels; channel++) {
+    _sums[channel] = _isr_sums[channel];
+    _micros[channel] = _isr_micros[channel];
+    _no_of_values[channel] = _isr_no_of_values[channel];
+  }
+  interrupts();
+}
+
+// RECORDING -------------------------------------------------------------------
+void Analog_acquisition::record_channel(byte channel) {
+  noInterrupts();
+  _recorded_channel = channel;
+  _record_tail = _record_head;
+  interrupts();
+}
+
+bool Analog_acquisition::read_recorded_value(int &value, unsigned long &value_micros) {
+  if (_record_tail == _record_head) {
+    return false;
+  }
+  value = get_mean(_record_sums[_record_tail]);
+  value_micros = _record_micros[_record_tail];
+  _record_tail = (_record_tail + 1) & (ANALOG_ACQUISITION_RECORD_SIZE - 1);
+  return true;
+}
+
+unsigned int Analog_acquisition::get_lost_recorded_values() {
+  noInterrupts();
+  unsigned int lost_values = _lost_recorded_values;
+  interrupts();
+  return lost_values;
+}
+
+// GETTER ----------------------------------------------------------------------
+int Analog_acquisition::get_mean(unsigned int sum) {
+  return (sum + ANALOG_ACQUISITION_OVERSAMPLING / 2) / ANALOG_ACQUISITION_OVERSAMPLING;
+}
+
+int Analog_acquisition::get_value(byte channel) { return get_mean(_sums[channel]); }
+
+unsigned int Analog_acquisition::get_sum(byte channel) { return _sums[channel]; }
+
+int Analog_acquisition::get_value_of_pin(byte pin) {
+  for (byte channel = 0; channel < _no_of_channels; channel++) {
+    if (_pins[channel] == pin) {
+      return get_value(channel);
+    }
+  }
+  return 0;
+}
+
+unsigned long Analog_acquisition::get_value_micros(byte channel) { return _micros[channel]; }
+
+unsigned long Analog_acquisition::get_no_of_values(byte channel) { return _no_of_values[channel]; }
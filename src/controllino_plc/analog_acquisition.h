@@ -0,0 +1,93 @@
+/* *****************************************************************************
+ * analog_acquisition.h ********************************************************
+ * *****************************************************************************
+ * Samples the analog inputs in the background, the loop reads the latest
+ * filtered value of every input without waiting for a conversion.
+ *
+ * Every input is oversampled: the sum of ANALOG_ACQUISITION_OVERSAMPLING
+ * conversions is stored with the micros() timestamp of the last conversion,
+ * then the next input is sampled. get_value() returns the mean of the sum,
+ * get_sum() keeps the additional resolution of the oversampling.
+ * update() takes over the latest sums of the interrupt, the getters only
+ * return copies.
+ * One channel can be recorded: every value of it is also written to a lock
+ * free ring buffer, read_recorded_value() returns the values in order, with
+ * the fixed sample rate of the acquisition, independent of the scan time.
+ *
+ * ATMEGA2560 (CONTROLLINO MEGA):
+ * - The ADC runs in free running mode, every conversion triggers the ADC
+ *   interrupt. The ADC clock is 16MHz/128, one conversion takes 104us.
+ * - A new channel is selected while the next conversion is already running,
+ *   the first conversion after a channel switch is discarded.
+ * - analogRead() must not be used while the acquisition is running.
+ *
+ * OTHER PLATFORMS:
+ * - Every input is read once with analogRead() when update() is called.
+ * *****************************************************************************
+ */
+
+#ifndef ANALOGACQUISITION_H
+#define ANALOGACQUISITION_H
+
+#include <Arduino.h>
+
+#define ANALOG_ACQUISITION_MAX_CHANNELS 4
+#define ANALOG_ACQUISITION_OVERSAMPLING 16 // the sum of 16 10bit values fits into 14bit
+#define ANALOG_ACQUISITION_RECORD_SIZE 16 // must be a power of two
+#define ANALOG_ACQUISITION_NO_RECORDING 0xFF
+
+class Analog_acquisition {
+
+public:
+  // FUNCTIONS:
+  Analog_acquisition();
+
+  byte add_input(byte pin);
+  void begin();
+  void update();
+
+  int get_value(byte channel); // mean [0-1023]
+  unsigned int get_sum(byte channel); // sum of the oversampled conversions
+  int get_value_of_pin(byte pin);
+  unsigned long get_value_micros(byte channel);
+  unsigned long get_no_of_values(byte channel);
+
+  void record_channel(byte channel); // ANALOG_ACQUISITION_NO_RECORDING to stop
+  bool read_recorded_value(int &value, unsigned long &value_micros);
+  unsigned int get_lost_recorded_values();
+
+  // Called by the interrupt service routine:
+  void store_conversion(unsigned int result);
+  static Analog_acquisition *active_instance;
+
+private:
+  // VARIABLES:
+  byte _pins[ANALOG_ACQUISITION_MAX_CHANNELS];
+  byte _no_of_channels;
+
+  // Written by the interrupt:
+  volatile unsigned int _isr_sums[ANALOG_ACQUISITION_MAX_CHANNELS];
+  volatile unsigned long _isr_micros[ANALOG_ACQUISITION_MAX_CHANNELS];
+  volatile unsigned long _isr_no_of_values[ANALOG_ACQUISITION_MAX_CHANNELS];
+  volatile byte _channel; // being sampled
+  volatile byte _no_of_conversions;
+  volatile unsigned int _running_sum;
+  volatile bool _skip_conversion;
+  volatile byte _recorded_channel;
+  volatile unsigned int _record_sums[ANALOG_ACQUISITION_RECORD_SIZE];
+  volatile unsigned long _record_micros[ANALOG_ACQUISITION_RECORD_SIZE];
+  volatile byte _record_head;
+  volatile unsigned int _lost_recorded_values;
+
+  // Written by the loop:
+  unsigned int _sums[ANALOG_ACQUISITION_MAX_CHANNELS];
+  unsigned long _micros[ANALOG_ACQUISITION_MAX_CHANNELS];
+  unsigned long _no_of_values[ANALOG_ACQUISITION_MAX_CHANNELS];
+  volatile byte _record_tail;
+
+  // FUNCTIONS:
+  void select_channel(byte channel);
+  void store_value(byte channel, unsigned int sum);
+  int get_mean(unsigned int sum);
+};
+#endif
@@ -0,0 +1,53 @@
+/*******************************************************************************
+ * coop_task.cpp ***************************************************************
+ *******************************************************************************/
+
+#include "coop_task.h"
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Coop_task::Coop_task() {
+  _stage = 0;
+  _active = false;
+  _completed = false;
+}
+
+// START AND STOP --------------------------------------------------------------
+void Coop_task::start() {
+  _stage = 0;
+  _active = true;
+  _completed = false;
+  _stage_delay.set_unstarted();
+}
+
+void Coop_task::abort() {
+  _active = false;
+  _completed = false;
+}
+
+bool Coop_task::is_active() { return _active; }
+
+// This is a "one time flag", state will be reseted after fist inquiry:
+bool Coop_task::is_completed() {
+  if (_completed) {
+    _completed = false;
+    return true;
+  } else {
+    return false;
+  }
+}
+
+// STAGE MANAGEMENT ------------------------------------------------------------
+byte Coop_task::get_stage() { return _stage; }
+
+void Coop_task::switch_to_next_stage() {
+  _stage++;
+  _stage_delay.set_unstarted();
+}
+
+void Coop_task::set_completed() {
+  _active = false;
+  _completed = true;
+}
+
+// Non blocking replacement for delay(), time starts with the first call:
+bool Coop_task::wait(unsigned long delay_time) { return _stage_delay.delay_time_is_up(delay_time); }
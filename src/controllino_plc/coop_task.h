@@ -0,0 +1,52 @@
+/* *****************************************************************************
+ * coop_task.h *****************************************************************
+ * *****************************************************************************
+ * A cooperative task replaces a blocking delay() sequence.
+ * The sequence is split into stages, the task remembers the current stage and
+ * waits without blocking. The caller runs the task once per loop:
+ *
+ * switch (task.get_stage()) {
+ * case 0:
+ *   do_something();
+ *   task.switch_to_next_stage();
+ *   break;
+ * case 1:
+ *   if (task.wait(500)) {
+ *     do_something_else();
+ *     task.set_completed();
+ *   }
+ *   break;
+ * }
+ * *****************************************************************************
+ */
+
+#ifndef COOPTASK_H
+#define COOPTASK_H
+
+#include <Arduino.h>
+#include <Insomnia.h> // https://github.com/chischte/insomnia-delay-library
+
+class Coop_task {
+
+public:
+  // FUNCTIONS:
+  Coop_task();
+
+  void start();
+  void abort();
+  bool is_active();
+  bool is_completed();
+
+  byte get_stage();
+  void switch_to_next_stage();
+  void set_completed();
+  bool wait(unsigned long delay_time);
+
+private:
+  // VARIABLES:
+  Insomnia _stage_delay;
+  byte _stage;
+  bool _active;
+  bool _completed;
+};
+#endif
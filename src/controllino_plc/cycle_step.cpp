@@ -1,16 +1,23 @@
 #include "cycle_step.h"
-#include <ArduinoSTL.h>
+#include <Arduino.h>
 
 Cycle_step::Cycle_step() { //
   object_count++;
 }
 
 void Cycle_step::do_stuff() {
+  Settle_time *settle_time = get_settle_time();
   if (!_innit_completed) {
     do_initial_stuff();
+    if (settle_time) {
+      settle_time->start();
+    }
     _innit_completed = true;
   } else {
     do_loop_stuff();
+    if (settle_time && !_loop_completed && settle_time->is_up(sensor_has_confirmed())) {
+      set_loop_completed();
+    }
   }
 }
 
@@ -1,6 +1,7 @@
 #ifndef CYCLESTEP_H
 #define CYCLESTEP_H
-#include <ArduinoSTL.h>
+#include <Arduino.h>
+#include <controllino_plc/settle_time.h>
 
 class Cycle_step {
 public:
@@ -16,12 +17,20 @@ public:
   virtual void do_initial_stuff() = 0;
   virtual void do_loop_stuff() = 0;
 
+  // SENSOR COMPLETION MODE:
+  // A step that returns a settle time is completed when sensor_has_confirmed()
+  // returns true or when the max settle time has passed, the settle time is
+  // started after do_initial_stuff(). Without a settle time the step
+  // completes itself with set_loop_completed().
+  virtual Settle_time *get_settle_time() { return 0; }
+  virtual bool sensor_has_confirmed() { return false; } // called every scan
+
   // SETTER:
   void set_loop_completed();
 
   // GETTER:
   bool is_completed();
-  virtual String get_display_text() = 0;
+  virtual const __FlashStringHelper *get_display_text() = 0; // name in flash, use F("...")
 
 private:
   // VARIABLES:
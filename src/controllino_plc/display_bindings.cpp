@@ -0,0 +1,67 @@
+/*******************************************************************************
+ * display_bindings.cpp ********************************************************
+ *******************************************************************************/
+
+#include "display_bindings.h"
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Display_bindings::Display_bindings(const Display_binding *bindings_in_flash, byte no_of_bindings,
+                                   byte bindings_per_scan) {
+  _bindings = bindings_in_flash;
+  _no_of_bindings = min(no_of_bindings, (byte)DISPLAY_BINDINGS_MAX_BINDINGS);
+  _bindings_per_scan = bindings_per_scan;
+  _next_binding = 0;
+  _shadow_is_valid = 0;
+}
+
+// REFRESH ---------------------------------------------------------------------
+void Display_bindings::update(byte current_page, Nextion_queue &queue) {
+  byte bindings_checked = 0;
+  for (byte i = 0; i < _no_of_bindings && bindings_checked < _bindings_per_scan; i++) {
+    byte index = _next_binding;
+    _next_binding = (_next_binding + 1) % _no_of_bindings;
+
+    if (pgm_read_byte(&_bindings[index].page) != current_page) {
+      continue;
+    }
+    bindings_checked++;
+
+    Display_binding binding;
+    memcpy_P(&binding, &_bindings[index], sizeof(binding));
+    long value = binding.getter();
+    unsigned long index_bit = 1UL << index;
+    if ((_shadow_is_valid & index_bit) && _shadow_values[index] == value) {
+      continue;
+    }
+    render(binding, value, queue);
+    _shadow_values[index] = value;
+    _shadow_is_valid |= index_bit;
+  }
+}
+
+void Display_bindings::invalidate() { _shadow_is_valid = 0; }
+
+void Display_bindings::render(const Display_binding &binding, long value, Nextion_queue &queue) {
+  switch (binding.render_kind) {
+  case render_ds_switch:
+  case render_value:
+    queue.print(binding.component);
+    queue.print(".val=");
+    queue.print(value);
+    break;
+  case render_momentary:
+    queue.print("click ");
+    queue.print(binding.component);
+    queue.print(",");
+    queue.print(value);
+    break;
+  case render_text:
+    queue.print(binding.component);
+    queue.print(".txt=\"");
+    queue.print(value);
+    queue.print(binding.suffix);
+    queue.print("\"");
+    break;
+  }
+  queue.end_command(binding.priority);
+}
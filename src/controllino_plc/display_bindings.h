@@ -0,0 +1,67 @@
+/* *****************************************************************************
+ * display_bindings.h **********************************************************
+ * *****************************************************************************
+ * Table driven refresh of the Nextion components.
+ *
+ * Every row of the binding table (kept in flash) maps a component of a page to
+ * a getter and a render kind. The last value sent of every binding is kept as
+ * a shadow copy, a command is only queued if the value has changed.
+ * Every scan only a limited number of bindings of the current page is
+ * checked, so the display costs the same time in every scan.
+ * After a page change, invalidate() sends all bindings of the page again.
+ * Every binding queues its commands with its own display priority.
+ *
+ * RENDER KINDS:
+ * render_ds_switch   <component>.val=<0/1>         dual state button
+ * render_momentary   click <component>,<0/1>        pressed or released button
+ * render_text        <component>.txt="<value><suffix>"
+ * render_value       <component>.val=<value>        number component
+ * *****************************************************************************
+ */
+
+#ifndef DISPLAYBINDINGS_H
+#define DISPLAYBINDINGS_H
+
+#include <Arduino.h>
+#include <controllino_plc/nextion_queue.h>
+
+#define DISPLAY_BINDINGS_MAX_BINDINGS 32
+
+enum Render_kind {
+  render_ds_switch, //
+  render_momentary, //
+  render_text, //
+  render_value //
+};
+
+struct Display_binding {
+  byte page;
+  char component[5];
+  byte render_kind;
+  long (*getter)();
+  char suffix[4]; // text only
+  byte priority; // Display_priority of the queued commands
+};
+
+class Display_bindings {
+
+public:
+  // FUNCTIONS:
+  Display_bindings(const Display_binding *bindings_in_flash, byte no_of_bindings, byte bindings_per_scan);
+
+  void update(byte current_page, Nextion_queue &queue);
+  void invalidate();
+
+private:
+  // VARIABLES:
+  const Display_binding *_bindings;
+  byte _no_of_bindings;
+  byte _bindings_per_scan;
+  byte _next_binding;
+  unsigned long _shadow_is_valid; // one bit per binding
+  long _shadow_values[DISPLAY_BINDINGS_MAX_BINDINGS];
+
+  // FUNCTIONS:
+  void render(const Display_binding &binding, long value, Nextion_queue &queue);
+};
+#endif
@@ -0,0 +1,93 @@
+/*******************************************************************************
+ * electrocylinder.cpp *********************************************************
+ *******************************************************************************/
+
+#include "electrocylinder.h"
+
+const unsigned long load_power_delay = 200; // [ms] >=50ms
+const unsigned long initializing_time = 8000; // [ms]
+const unsigned long disconnect_outputs_delay = 200; // [ms] >=100ms
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Electrocylinder::Electrocylinder(byte logic_power_relay, byte trennrelais_1, byte trennrelais_2, byte move_in,
+                                 byte move_out) {
+  _logic_power_relay = logic_power_relay;
+  _trennrelais_1 = trennrelais_1;
+  _trennrelais_2 = trennrelais_2;
+  _move_in = move_in;
+  _move_out = move_out;
+  _power_state = powered_off;
+  _power_on_pending = false;
+}
+
+// POWER ON AND OFF ------------------------------------------------------------
+void Electrocylinder::power_on() {
+  if (_power_state == powered_off) {
+    Serial.println("ELEKTROZYLINDER POWER ON:");
+    switch_to_state(waiting_for_load_power);
+  }
+  // Power on as soon as power off has been completed:
+  if (_power_state == disconnecting_outputs) {
+    _power_on_pending = true;
+  }
+}
+
+void Electrocylinder::power_off() {
+  _power_on_pending = false;
+  if (_power_state == powered_off || _power_state == disconnecting_outputs) {
+    return;
+  }
+  digitalWrite(_move_in, LOW);
+  digitalWrite(_move_out, LOW);
+
+  // Disconnect electrocylinder analog outputs:
+  digitalWrite(_trennrelais_1, LOW);
+  digitalWrite(_trennrelais_2, LOW);
+  switch_to_state(disconnecting_outputs);
+}
+
+// SEQUENCER (CALL EVERY LOOP) -------------------------------------------------
+void Electrocylinder::update() {
+  switch (_power_state) {
+  case waiting_for_load_power:
+    if (_power_delay.delay_time_is_up(load_power_delay)) {
+      digitalWrite(_logic_power_relay, HIGH);
+      switch_to_state(initializing);
+    }
+    break;
+  case initializing:
+    if (_power_delay.delay_time_is_up(initializing_time)) {
+      digitalWrite(_trennrelais_1, HIGH);
+      digitalWrite(_trennrelais_2, HIGH);
+      switch_to_state(ready);
+      Serial.println("ELEKTROZYLINDER BEREIT");
+    }
+    break;
+  case disconnecting_outputs:
+    if (_power_delay.delay_time_is_up(disconnect_outputs_delay)) {
+      digitalWrite(_logic_power_relay, LOW);
+      switch_to_state(powered_off);
+      if (_power_on_pending) {
+        _power_on_pending = false;
+        power_on();
+      }
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+void Electrocylinder::switch_to_state(power_state new_state) {
+  _power_state = new_state;
+  _power_delay.set_unstarted();
+}
+
+// GETTER ----------------------------------------------------------------------
+bool Electrocylinder::is_ready() { return _power_state == ready; }
+
+bool Electrocylinder::is_powering_on() {
+  return _power_state == waiting_for_load_power || _power_state == initializing || _power_on_pending;
+}
+
+bool Electrocylinder::is_powered_off() { return _power_state == powered_off; }
@@ -0,0 +1,58 @@
+/* *****************************************************************************
+ * electrocylinder.h ***********************************************************
+ * *****************************************************************************
+ * Power sequencer for the Festo ELGS-BS electrocylinder (foerderzylinder).
+ * Power up and power down run in the background, update() has to be called
+ * every loop.
+ *
+ * Festo specification ELGS-BS:
+ * - Turn on logic power >=50ms after load power
+ * - Turn off analog outputs >=100ms before logic power
+ * - The cylinder needs about 8s to initialize after logic power on
+ * *****************************************************************************
+ */
+
+#ifndef ELECTROCYLINDER_H
+#define ELECTROCYLINDER_H
+
+#include <Arduino.h>
+#include <Insomnia.h> // https://github.com/chischte/insomnia-delay-library
+
+class Electrocylinder {
+
+public:
+  // FUNCTIONS:
+  Electrocylinder(byte logic_power_relay, byte trennrelais_1, byte trennrelais_2, byte move_in, byte move_out);
+
+  void update();
+  void power_on();
+  void power_off();
+
+  bool is_ready();
+  bool is_powering_on();
+  bool is_powered_off();
+
+private:
+  // VARIABLES:
+  enum power_state {
+    powered_off, //
+    waiting_for_load_power, //
+    initializing, //
+    ready, //
+    disconnecting_outputs //
+  };
+  power_state _power_state;
+  bool _power_on_pending;
+
+  byte _logic_power_relay;
+  byte _trennrelais_1;
+  byte _trennrelais_2;
+  byte _move_in;
+  byte _move_out;
+
+  Insomnia _power_delay;
+
+  // FUNCTIONS:
+  void switch_to_state(power_state new_state);
+};
+#endif
@@ -0,0 +1,199 @@
+/*******************************************************************************
+ * force_profile.cpp ***********************************************************
+ *******************************************************************************/
+
+#include "force_profile.h"
+#include <common/small_string.h>
+
+const byte max_curve_line_length = 56; // fits into the TX buffer of 64 bytes with the line end
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Force_profile::Force_profile(unsigned int sample_interval, bool log_curve) {
+  _sample_interval = sample_interval;
+  _log_curve = log_curve;
+  _is_running = false;
+  _report_is_pending = false;
+  _start_micros = 0;
+  _no_of_samples = 0;
+  _bucket = 0;
+  _bucket_sum = 0;
+  _bucket_count = 0;
+  _peak = 0;
+  _time_to_peak = 0;
+  _rise_time = -1;
+  _plateau_sum = 0;
+  _features_are_sent = false;
+  _next_curve_sample = 0;
+}
+
+// RECORDING -------------------------------------------------------------------
+void Force_profile::start() {
+  _is_running = true;
+  _report_is_pending = false; // an unsent report of the previous stroke is dropped
+  _start_micros = micros();
+  _no_of_samples = 0;
+  _bucket = 0;
+  _bucket_sum = 0;
+  _bucket_count = 0;
+  _peak = 0;
+  _time_to_peak = 0;
+  _rise_time = -1;
+  _plateau_sum = 0;
+}
+
+void Force_profile::add_value(int force, unsigned long value_micros) {
+  if (!_is_running || long(value_micros - _start_micros) < 0) {
+    return; // acquired before the start
+  }
+  unsigned long bucket = (value_micros - _start_micros) / (_sample_interval * 1000UL);
+  while (_bucket < bucket) {
+    close_bucket();
+  }
+  _bucket_sum += force;
+  _bucket_count++;
+}
+
+void Force_profile::stop() {
+  if (!_is_running) {
+    return;
+  }
+  if (_bucket_count) {
+    close_bucket();
+  }
+  _is_running = false;
+  calculate_rise_time();
+  _report_is_pending = _no_of_samples > 0;
+  _features_are_sent = false;
+  _next_curve_sample = get_first_stored_sample();
+}
+
+// An interval without a value repeats the previous sample:
+void Force_profile::close_bucket() {
+  if (_bucket_count) {
+    store_sample(_bucket_sum / _bucket_count);
+  } else {
+    store_sample(_no_of_samples ? get_sample(_no_of_samples - 1) : 0);
+  }
+  _bucket++;
+  _bucket_sum = 0;
+  _bucket_count = 0;
+}
+
+void Force_profile::store_sample(int force) {
+  unsigned int index = _no_of_samples++;
+  _samples[index % FORCE_PROFILE_SIZE] = force;
+
+  if (index == 0 || force > _peak) {
+    _peak = force;
+    _time_to_peak = long(index) * _sample_interval;
+  }
+  _plateau_sum += force;
+  if (index >= FORCE_PROFILE_PLATEAU_SAMPLES) {
+    _plateau_sum -= get_sample(index - FORCE_PROFILE_PLATEAU_SAMPLES);
+  }
+}
+
+int Force_profile::get_sample(unsigned int index) { return _samples[index % FORCE_PROFILE_SIZE]; }
+
+unsigned int Force_profile::get_first_stored_sample() {
+  return _no_of_samples > FORCE_PROFILE_SIZE ? _no_of_samples - FORCE_PROFILE_SIZE : 0;
+}
+
+void Force_profile::calculate_rise_time() {
+  _rise_time = -1;
+  if (_peak <= 0) {
+    return;
+  }
+  int low_force = long(_peak) * 10 / 100;
+  int high_force = long(_peak) * 90 / 100;
+  unsigned int first = get_first_stored_sample();
+  if (first > 0 && get_sample(first) >= low_force) {
+    return; // the start of the rise has been overwritten
+  }
+  long low_index = -1;
+  for (unsigned int i = first; i < _no_of_samples; i++) {
+    int force = get_sample(i);
+    if (low_index < 0 && force >= low_force) {
+      low_index = i;
+    }
+    if (force >= high_force) {
+      _rise_time = (long(i) - low_index) * _sample_interval;
+      return;
+    }
+  }
+}
+
+// REPORT ----------------------------------------------------------------------
+void Force_profile::send_report(HardwareSerial &port) {
+  if (!_report_is_pending) {
+    return;
+  }
+  Small_string<64> line;
+
+  if (!_features_are_sent) {
+    line.print("LOG;FORCE_PROFILE;");
+    line.print(_peak);
+    line.print(";");
+    line.print(_time_to_peak);
+    line.print(";");
+    line.print(_rise_time);
+    line.print(";");
+    line.print(get_plateau_mean());
+    line.print(";");
+    line.print(_no_of_samples);
+    line.print(";");
+    line.print(_no_of_samples - get_first_stored_sample());
+    line.print(";");
+    line.print(_sample_interval);
+    line.print(";\r\n");
+    if (port.availableForWrite() < line.length()) {
+      return;
+    }
+    port.print(line.c_str());
+    _features_are_sent = true;
+    _report_is_pending = _log_curve;
+    return;
+  }
+
+  line.print("LOG;FORCE_CURVE;");
+  line.print(_next_curve_sample);
+  line.print(";");
+  unsigned int sample = _next_curve_sample;
+  int previous_force = sample == get_first_stored_sample() ? 0 : get_sample(sample - 1);
+  while (sample < _no_of_samples) {
+    Small_string<8> delta;
+    if (sample != _next_curve_sample) {
+      delta.print(",");
+    }
+    delta.print(get_sample(sample) - previous_force);
+    if (line.length() + delta.length() > max_curve_line_length) {
+      break;
+    }
+    line.print(delta.c_str());
+    previous_force = get_sample(sample);
+    sample++;
+  }
+  line.print(";\r\n");
+  if (port.availableForWrite() < line.length()) {
+    return;
+  }
+  port.print(line.c_str());
+  _next_curve_sample = sample;
+  _report_is_pending = _next_curve_sample < _no_of_samples;
+}
+
+// GETTER ----------------------------------------------------------------------
+bool Force_profile::is_running() { return _is_running; }
+
+int Force_profile::get_peak() { return _peak; }
+
+long Force_profile::get_time_to_peak() { return _time_to_peak; }
+
+long Force_profile::get_rise_time() { return _rise_time; }
+
+int Force_profile::get_plateau_mean() {
+  unsigned int no_of_plateau_samples = min(_no_of_samples, (unsigned int)FORCE_PROFILE_PLATEAU_SAMPLES);
+  return no_of_plateau_samples ? _plateau_sum / no_of_plateau_samples : 0;
+}
+
+unsigned int Force_profile::get_no_of_samples() { return _no_of_samples; }
@@ -0,0 +1,83 @@
+/* *****************************************************************************
+ * force_profile.h *************************************************************
+ * *****************************************************************************
+ * Records the force curve of one tension stroke and extracts its features.
+ *
+ * The force values (with their acquisition timestamps) are averaged to one
+ * sample per sample interval and stored in a RAM ring buffer of
+ * FORCE_PROFILE_SIZE samples, a longer stroke keeps its last samples.
+ * Peak, time to peak and the plateau mean (mean of the last
+ * FORCE_PROFILE_PLATEAU_SAMPLES samples) are updated with every sample.
+ * The rise time (10% to 90% of the peak) is taken from the buffer when the
+ * stroke ends, it is -1 if the start of the rise is no longer in the buffer.
+ *
+ * send_report() sends the features once per stroke, optionally followed by
+ * the delta compressed curve, in complete lines that fit into the free TX
+ * buffer, so it never blocks the loop:
+ * LOG;FORCE_PROFILE;<peak>;<time to peak>;<rise time>;<plateau mean>;<samples>;<stored samples>;<interval>;
+ * LOG;FORCE_CURVE;<index of the first sample>;<delta>,<delta>,...;
+ * The curve has the stored samples (the last FORCE_PROFILE_SIZE samples of a
+ * longer stroke), its first delta is relative to 0. Times in [ms], forces in [N].
+ * *****************************************************************************
+ */
+
+#ifndef FORCEPROFILE_H
+#define FORCEPROFILE_H
+
+#include <Arduino.h>
+
+#define FORCE_PROFILE_SIZE 256
+#define FORCE_PROFILE_PLATEAU_SAMPLES 32
+
+class Force_profile {
+
+public:
+  // FUNCTIONS:
+  Force_profile(unsigned int sample_interval, bool log_curve);
+
+  void start();
+  void add_value(int force, unsigned long value_micros);
+  void stop();
+  void send_report(HardwareSerial &port);
+
+  // GETTER:
+  bool is_running();
+  int get_peak();
+  long get_time_to_peak();
+  long get_rise_time();
+  int get_plateau_mean();
+  unsigned int get_no_of_samples();
+
+private:
+  // VARIABLES:
+  unsigned int _sample_interval; // [ms]
+  bool _log_curve;
+  bool _is_running;
+  unsigned long _start_micros;
+  int _samples[FORCE_PROFILE_SIZE];
+  unsigned int _no_of_samples; // also counts the overwritten samples
+
+  // Sample being averaged:
+  unsigned int _bucket; // sample index
+  long _bucket_sum;
+  byte _bucket_count;
+
+  // Features:
+  int _peak;
+  long _time_to_peak;
+  long _rise_time;
+  long _plateau_sum;
+
+  // Report:
+  bool _report_is_pending;
+  bool _features_are_sent;
+  unsigned int _next_curve_sample;
+
+  // FUNCTIONS:
+  void close_bucket();
+  void store_sample(int force);
+  int get_sample(unsigned int index);
+  unsigned int get_first_stored_sample();
+  void calculate_rise_time();
+};
+#endif
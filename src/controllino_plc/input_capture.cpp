@@ -0,0 +1,202 @@
+/*******************************************************************************
+ * input_capture.cpp ***********************************************************
+ *******************************************************************************/
+
+#include "input_capture.h"
+
+Input_capture *Input_capture::active_instance = 0;
+
+// INTERRUPT SERVICE ROUTINES --------------------------------------------------
+#ifdef __AVR__
+ISR(TIMER0_COMPA_vect) {
+  if (Input_capture::active_instance) {
+    Input_capture::active_instance->sample_inputs();
+  }
+}
+
+#ifdef PCINT0_vect
+ISR(PCINT0_vect) {
+  if (Input_capture::active_instance) {
+    Input_capture::active_instance->sample_inputs();
+  }
+}
+#endif
+
+#ifdef PCINT2_vect
+ISR(PCINT2_vect) {
+  if (Input_capture::active_instance) {
+    Input_capture::active_instance->sample_inputs();
+  }
+}
+#endif
+#endif
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Input_capture::Input_capture(byte stable_time) {
+  _no_of_channels = 0;
+  _stable_micros = stable_time * 1000UL;
+  _head = 0;
+  _tail = 0;
+  _levels = 0;
+  _lost_edges = 0;
+  _stable_levels = 0;
+  _bouncing_channels = 0;
+  _rising_edges = 0;
+  _falling_edges = 0;
+}
+
+// SETUP -----------------------------------------------------------------------
+// Returns the channel number of the input:
+byte Input_capture::add_input(byte pin) {
+  if (_no_of_channels >= INPUT_CAPTURE_MAX_CHANNELS) {
+    return INPUT_CAPTURE_MAX_CHANNELS - 1;
+  }
+  byte channel = _no_of_channels;
+  _pins[channel] = pin;
+#ifdef __AVR__
+  _input_registers[channel] = portInputRegister(digitalPinToPort(pin));
+  _bit_masks[channel] = digitalPinToBitMask(pin);
+#endif
+  _no_of_channels++;
+  return channel;
+}
+
+void Input_capture::begin() {
+  for (byte channel = 0; channel < _no_of_channels; channel++) {
+    if (read_input(channel)) {
+      _levels |= (1 << channel);
+    }
+  }
+  _stable_levels = _levels;
+  active_instance = this;
+
+#ifdef __AVR__
+  noInterrupts();
+  // Enable pin change interrupts where available:
+  for (byte channel = 0; channel < _no_of_channels; channel++) {
+    byte pin = _pins[channel];
+    if (digitalPinToPCICR(pin)) {
+      *digitalPinToPCICR(pin) |= (1 << digitalPinToPCICRbit(pin));
+      *digitalPinToPCMSK(pin) |= (1 << digitalPinToPCMSKbit(pin));
+    }
+  }
+  // Sample all inputs once per millisecond (Timer0 is used for millis()):
+  OCR0A = 0x80;
+  TIMSK0 |= (1 << OCIE0A);
+  interrupts();
+#endif
+}
+
+// SAMPLE INPUTS (PRODUCER) ----------------------------------------------------
+bool Input_capture::read_input(byte channel) {
+#ifdef __AVR__
+  return *_input_registers[channel] & _bit_masks[channel];
+#else
+  return digitalRead(_pins[channel]);
+#endif
+}
+
+void Input_capture::sample_inputs() {
+  unsigned long now = micros();
+  for (byte channel = 0; channel < _no_of_channels; channel++) {
+    byte channel_bit = (1 << channel);
+    bool level = read_input(channel);
+    if (level == bool(_levels & channel_bit)) {
+      continue;
+    }
+    _levels ^= channel_bit;
+
+    byte next_head = (_head + 1) & (INPUT_CAPTURE_BUFFER_SIZE - 1);
+    if (next_head == _tail) {
+      _lost_edges++; // buffer full
+      continue;
+    }
+    _edge_channels[_head] = channel;
+    _edge_micros[_head] = now;
+    _head = next_head;
+  }
+}
+
+// READ EDGES (CONSUMER) -------------------------------------------------------
+void Input_capture::update() {
+#ifndef __AVR__
+  sample_inputs();
+#endif
+  byte levels = _levels; // read before the edges, a later edge is not yet stable
+  read_edges();
+  latch_stable_levels(levels);
+}
+
+void Input_capture::read_edges() {
+  while (_tail != _head) {
+    byte channel = _edge_channels[_tail];
+    byte channel_bit = (1 << channel);
+    if (!(_bouncing_channels & channel_bit)) {
+      _bouncing_channels |= channel_bit;
+      _burst_start_micros[channel] = _edge_micros[_tail];
+    }
+    _last_edge_micros[channel] = _edge_micros[_tail];
+    _tail = (_tail + 1) & (INPUT_CAPTURE_BUFFER_SIZE - 1);
+  }
+}
+
+void Input_capture::latch_stable_levels(byte levels) {
+  unsigned long now = micros();
+  for (byte channel = 0; channel < _no_of_channels; channel++) {
+    byte channel_bit = (1 << channel);
+    if (!(_bouncing_channels & channel_bit)) {
+      if ((levels ^ _stable_levels) & channel_bit) { // the edge was lost in a full buffer
+        _bouncing_channels |= channel_bit;
+        _burst_start_micros[channel] = now;
+        _last_edge_micros[channel] = now;
+      }
+      continue;
+    }
+    if (now - _last_edge_micros[channel] < _stable_micros) {
+      continue;
+    }
+    _bouncing_channels &= ~channel_bit;
+    if ((levels & channel_bit) == (_stable_levels & channel_bit)) {
+      continue; // a spike, the level is back where it was
+    }
+    _stable_levels ^= channel_bit;
+    if (levels & channel_bit) {
+      _rising_edges |= channel_bit;
+      _rising_edge_micros[channel] = _burst_start_micros[channel];
+    } else {
+      _falling_edges |= channel_bit;
+    }
+  }
+}
+
+// Forget edges that happened before, e.g. at the start of a cycle step:
+void Input_capture::clear_edges(byte channel) {
+  update();
+  _rising_edges &= ~(1 << channel);
+  _falling_edges &= ~(1 << channel);
+}
+
+// These are "one time flags", state will be reseted after fist inquiry:
+bool Input_capture::switched_high(byte channel) {
+  byte channel_bit = (1 << channel);
+  bool has_switched = _rising_edges & channel_bit;
+  _rising_edges &= ~channel_bit;
+  return has_switched;
+}
+
+bool Input_capture::switched_low(byte channel) {
+  byte channel_bit = (1 << channel);
+  bool has_switched = _falling_edges & channel_bit;
+  _falling_edges &= ~channel_bit;
+  return has_switched;
+}
+
+// GETTER ----------------------------------------------------------------------
+unsigned long Input_capture::get_rising_edge_micros(byte channel) { return _rising_edge_micros[channel]; }
+
+unsigned int Input_capture::get_lost_edges() {
+  noInterrupts();
+  unsigned int lost_edges = _lost_edges;
+  interrupts();
+  return lost_edges;
+}
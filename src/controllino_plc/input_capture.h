@@ -0,0 +1,87 @@
+/* *****************************************************************************
+ * input_capture.h *************************************************************
+ * *****************************************************************************
+ * Captures the edges of digital inputs in the background, independent of the
+ * scan time of the main loop. Every edge is stored with a micros() timestamp
+ * in a lock-free single-producer (interrupt) single-consumer (loop) ring
+ * buffer. update() moves the edges to the latches of the channels.
+ *
+ * DEBOUNCING:
+ * A new level is latched when the input has not changed for the stable time.
+ * Its timestamp is the first edge of the burst, the bouncing does not delay
+ * the measured time, only the moment the edge is reported.
+ *
+ * ATMEGA2560 (CONTROLLINO MEGA):
+ * - Inputs with a pin change interrupt (A8-A15 on port K) are sampled on
+ *   every pin change.
+ * - Inputs without a pin change interrupt (A0-A7 on port F) are sampled by
+ *   the Timer0 compare match interrupt, about once per millisecond.
+ *   Timer0 keeps running unchanged for millis().
+ *
+ * OTHER PLATFORMS:
+ * - The inputs are sampled when update() is called.
+ * *****************************************************************************
+ */
+
+#ifndef INPUTCAPTURE_H
+#define INPUTCAPTURE_H
+
+#include <Arduino.h>
+
+#define INPUT_CAPTURE_MAX_CHANNELS 8
+#define INPUT_CAPTURE_BUFFER_SIZE 32 // must be a power of two
+
+class Input_capture {
+
+public:
+  // FUNCTIONS:
+  Input_capture(byte stable_time); // [ms]
+
+  byte add_input(byte pin);
+  void begin();
+  void update();
+
+  void clear_edges(byte channel);
+  bool switched_high(byte channel);
+  bool switched_low(byte channel);
+  unsigned long get_rising_edge_micros(byte channel); // of the last latched rising edge
+  unsigned int get_lost_edges();
+
+  // Called by the interrupt service routines:
+  void sample_inputs();
+  static Input_capture *active_instance;
+
+private:
+  // VARIABLES:
+  byte _pins[INPUT_CAPTURE_MAX_CHANNELS];
+  byte _no_of_channels;
+  unsigned long _stable_micros;
+
+  // Written by the interrupt:
+  volatile byte _edge_channels[INPUT_CAPTURE_BUFFER_SIZE];
+  volatile unsigned long _edge_micros[INPUT_CAPTURE_BUFFER_SIZE];
+  volatile byte _head;
+  volatile byte _levels; // one bit per channel
+  volatile unsigned int _lost_edges;
+
+  // Written by the loop:
+  volatile byte _tail;
+  byte _stable_levels; // one bit per channel
+  byte _bouncing_channels; // one bit per channel, edges not yet stable
+  unsigned long _burst_start_micros[INPUT_CAPTURE_MAX_CHANNELS];
+  unsigned long _last_edge_micros[INPUT_CAPTURE_MAX_CHANNELS];
+  byte _rising_edges; // one bit per channel
+  byte _falling_edges; // one bit per channel
+  unsigned long _rising_edge_micros[INPUT_CAPTURE_MAX_CHANNELS];
+
+#ifdef __AVR__
+  volatile uint8_t *_input_registers[INPUT_CAPTURE_MAX_CHANNELS];
+  uint8_t _bit_masks[INPUT_CAPTURE_MAX_CHANNELS];
+#endif
+
+  // FUNCTIONS:
+  bool read_input(byte channel);
+  void read_edges();
+  void latch_stable_levels(byte levels);
+};
+#endif
@@ -0,0 +1,105 @@
+/*******************************************************************************
+ * input_trace.cpp *************************************************************
+ *******************************************************************************/
+
+#include "input_trace.h"
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Input_trace::Input_trace(const byte *digital_pins, byte no_of_digital_pins, const byte *analog_pins,
+                         byte no_of_analog_pins, unsigned long analog_interval) {
+  _digital_pins = digital_pins;
+  _analog_pins = analog_pins;
+  _no_of_digital_pins = min(no_of_digital_pins, (byte)INPUT_TRACE_MAX_DIGITAL_INPUTS);
+  _no_of_analog_pins = min(no_of_analog_pins, (byte)INPUT_TRACE_MAX_ANALOG_INPUTS);
+  _analog_interval = analog_interval;
+  _previous_analog_millis = 0;
+  _previous_levels = 0;
+  _is_first_trace = true;
+  _analog_reader = analogRead;
+  _batch_start_millis = 0;
+  _previous_entry_millis = 0;
+  _previous_entry_length = 0;
+}
+
+void Input_trace::set_analog_reader(int (*analog_reader)(uint8_t pin)) { _analog_reader = analog_reader; }
+
+// RECORDING -------------------------------------------------------------------
+void Input_trace::send_trace(HardwareSerial &port) {
+  unsigned long levels = 0;
+  for (byte i = 0; i < _no_of_digital_pins; i++) {
+    if (digitalRead(_digital_pins[i])) {
+      levels |= 1UL << i;
+    }
+  }
+
+  unsigned long now = millis();
+  if (batch_is_due(now) && port.availableForWrite() >= _batch.length() + 2) {
+    send_batch(port);
+  }
+
+  bool analog_is_due = _is_first_trace || now - _previous_analog_millis >= _analog_interval;
+  if (levels == _previous_levels && !analog_is_due) {
+    return;
+  }
+
+  if (analog_is_due) {
+    for (byte i = 0; i < _no_of_analog_pins; i++) {
+      _analog_values[i] = _analog_reader(_analog_pins[i]);
+    }
+    _previous_analog_millis = now;
+  }
+  _previous_levels = levels;
+  _is_first_trace = false;
+
+  Small_string<INPUT_TRACE_MAX_LINE_LENGTH + 1> entry;
+  print_entry(entry, _batch.length() ? now - _previous_entry_millis : 0, levels);
+  if (_batch.length() && _batch.length() + entry.length() > INPUT_TRACE_MAX_LINE_LENGTH) {
+    send_batch(port); // waits for the port, an entry is never lost
+    entry.clear();
+    print_entry(entry, 0, levels);
+  }
+  if (!_batch.length()) {
+    _batch.print("TRACES;");
+    _batch.print(now);
+    _batch.print(";");
+    _batch_start_millis = now;
+  }
+  _batch.print(entry.c_str());
+  _previous_entry_millis = now;
+  _previous_entry_length = entry.length();
+}
+
+// Due when it is old or when the next entry will probably not fit:
+bool Input_trace::batch_is_due(unsigned long now) {
+  if (!_batch.length()) {
+    return false;
+  }
+  return now - _batch_start_millis >= INPUT_TRACE_MAX_BATCH_TIME ||
+         _batch.length() + _previous_entry_length > INPUT_TRACE_MAX_LINE_LENGTH;
+}
+
+// <dt>,<levels>,<analog 0>,<analog 1>;
+void Input_trace::print_entry(Print &text, unsigned long dt, unsigned long levels) {
+  text.print(dt);
+  text.print(",");
+  text.print(levels);
+  for (byte i = 0; i < _no_of_analog_pins; i++) {
+    text.print(",");
+    text.print(_analog_values[i]);
+  }
+  text.print(";");
+}
+
+void Input_trace::send_batch(Print &port) {
+  port.println(_batch.c_str());
+  _batch.clear();
+}
+
+// GETTER ----------------------------------------------------------------------
+byte Input_trace::get_no_of_digital_pins() const { return _no_of_digital_pins; }
+
+byte Input_trace::get_digital_pin(byte input) const { return _digital_pins[input]; }
+
+byte Input_trace::get_no_of_analog_pins() const { return _no_of_analog_pins; }
+
+byte Input_trace::get_analog_pin(byte input) const { return _analog_pins[input]; }
@@ -0,0 +1,71 @@
+/* *****************************************************************************
+ * input_trace.h ***************************************************************
+ * *****************************************************************************
+ * Records the raw levels of the digital inputs and the values of the analog
+ * inputs, so that a production run can be replayed offline by the native
+ * simulation (see src/native_simulation/trace_player.h).
+ *
+ * An entry is recorded whenever a digital level changes, and every analog
+ * interval. The entries are collected in one line, which is sent when it is
+ * full or INPUT_TRACE_MAX_BATCH_TIME after its first entry, as soon as it
+ * fits into the TX buffer:
+ * TRACES;<millis>;<dt>,<levels>,<analog 0>,<analog 1>;<dt>,<levels>,...;
+ * dt [ms] is the time since the previous entry of the line (0 for the first),
+ * bit n of the digital levels is input n.
+ *
+ * Recording is only compiled in with -D TRACE_INPUTS, with an analog interval
+ * of 100ms it adds about 200 bytes/s in about 4 lines/s on the log port. The analog values are read
+ * with analogRead(), or with the reader set by set_analog_reader() (e.g.
+ * when the ADC is used by a background acquisition).
+ * *****************************************************************************
+ */
+
+#ifndef INPUTTRACE_H
+#define INPUTTRACE_H
+
+#include <Arduino.h>
+#include <common/small_string.h>
+
+#define INPUT_TRACE_MAX_DIGITAL_INPUTS 32
+#define INPUT_TRACE_MAX_ANALOG_INPUTS 4
+#define INPUT_TRACE_MAX_LINE_LENGTH 61 // fits into the TX buffer of 64 bytes with the line end
+#define INPUT_TRACE_MAX_BATCH_TIME 1000 // [ms]
+
+class Input_trace {
+
+public:
+  // FUNCTIONS:
+  Input_trace(const byte *digital_pins, byte no_of_digital_pins, const byte *analog_pins,
+              byte no_of_analog_pins, unsigned long analog_interval);
+
+  void send_trace(HardwareSerial &port);
+  void set_analog_reader(int (*analog_reader)(uint8_t pin));
+
+  byte get_no_of_digital_pins() const;
+  byte get_digital_pin(byte input) const;
+  byte get_no_of_analog_pins() const;
+  byte get_analog_pin(byte input) const;
+
+private:
+  // VARIABLES:
+  const byte *_digital_pins;
+  const byte *_analog_pins;
+  byte _no_of_digital_pins;
+  byte _no_of_analog_pins;
+  unsigned long _analog_interval;
+  unsigned long _previous_analog_millis;
+  unsigned long _previous_levels;
+  bool _is_first_trace;
+  int _analog_values[INPUT_TRACE_MAX_ANALOG_INPUTS];
+  int (*_analog_reader)(uint8_t pin);
+  Small_string<INPUT_TRACE_MAX_LINE_LENGTH + 1> _batch;
+  unsigned long _batch_start_millis;
+  unsigned long _previous_entry_millis;
+  byte _previous_entry_length;
+
+  // FUNCTIONS:
+  void print_entry(Print &text, unsigned long dt, unsigned long levels);
+  bool batch_is_due(unsigned long now);
+  void send_batch(Print &port);
+};
+#endif
@@ -9,13 +9,15 @@
  * -----------------------------------------------------------------------------
  * RUNTIME:
  * Measured runtime: 220-250 micros
+ * The scan times are sent as LOG;SCAN_PROFILE lines on Serial1
+ * With -D PRINT_DEBUG_INFO the longest scan time of every second is printed
+ * to Serial, one line per scan when it fits into the TX buffer
  * -----------------------------------------------------------------------------
  * *****************************************************************************
  */
 
 // INCLUDE HEADERS *************************************************************
 
-#include <ArduinoSTL.h> //      https://github.com/mike-matera/ArduinoSTL
 #include <Controllino.h> //     PIO Controllino Library
 #include <Cylinder.h> //        https://github.com/chischte/cylinder-library
 #include <Debounce.h> //        https://github.com/chischte/debounce-library
@@ -24,39 +26,44 @@
 #include <Nextion.h> //         PIO Nextion library
 #include <SD.h> //              PIO Adafruit SD library
 
+#include <common/heap_monitor.h> //               counts heap allocations since startup
+#include <common/sensor_conversion.h> //          fixed point sensor conversions, calibration in EEPROM
+#include <common/small_string.h> //               allocation free text formatting
 #include <controllino_plc/alias_colino.h> //      aliases when using an Arduino instead of a Controllino
+#include <controllino_plc/analog_acquisition.h> // oversampled analog inputs read in the background
+#include <controllino_plc/coop_task.h> //         non blocking replacement for delay() sequences
 #include <controllino_plc/cycle_step.h> //        blueprint of a cycle step
+#include <controllino_plc/display_bindings.h> //  table driven refresh of the display components
+#include <controllino_plc/electrocylinder.h> //   power sequencer of the electrocylinder
+#include <controllino_plc/force_profile.h> //     force curve and features of every tension stroke
+#include <controllino_plc/input_capture.h> //     timestamped sensor edges independent of scan time
+#include <controllino_plc/input_trace.h> //       records the inputs for an offline replay
+#include <controllino_plc/nextion_queue.h> //     non blocking, coalescing display commands
+#include <controllino_plc/scan_profiler.h> //     runtime statistics of the main loop sections
+#include <controllino_plc/settle_time.h> //       completes a step by sensor, learns the actuation time
 #include <controllino_plc/state_controller.h> //  keeps track of machine states
+#include <controllino_plc/step_timer.h> //        measures the duration of every cycle step
+#include <controllino_plc/touch_dispatcher.h> //  receives the touch events of the display
+#include <controllino_plc/waveform_stream.h> //   live force curve on the display
 
 // DECLARE FUNCTIONS IF NEEDED FOR THE COMPILER: *******************************
 
-void clear_text_field(String textField);
-void hide_info_field();
+void clear_text_field(const char *text_field, byte priority = priority_process);
+void hide_info_field(byte priority = priority_process);
 void page_0_push(void *ptr);
 void page_1_push(void *ptr);
 void page_2_push(void *ptr);
-void display_loop_page_1_left_side();
-void display_loop_page_1_right_side();
-void display_loop_page_2_left_side();
-void display_loop_page_2_right_side();
-void display_text_in_info_field(String text);
+void display_text_in_info_field(const char *text, byte priority = priority_process);
 void update_cycle_name();
-void update_upper_slider_value();
-void update_lower_slider_value();
-void update_upper_counter_value();
-void update_switches_page_2_left();
-void update_lower_counter_value();
 void reset_lower_counter_value();
 void increase_slider_value(int eeprom_value_number);
 void decrease_slider_value(int eeprom_value_number);
-void update_field_values_page_2();
-void show_info_field();
+void show_info_field(byte priority = priority_process);
 void display_temperature();
-void display_text_in_field(String text, String textField);
-void error_stop_machine(String error_message);
-void power_on_electrocylinder();
-String get_main_cycle_display_string();
-String add_suffix_to_eeprom_value(int eeprom_value_number, String suffix);
+void display_text_in_field(const char *text, const char *text_field, byte priority = priority_process);
+void error_stop_machine(const char *error_message);
+void stop_machine(const char *error_message);
+Cycle_step *get_cycle_step(int step);
 
 // DEFINE COUNTER ENUM ******************************************
 
@@ -69,10 +76,28 @@ enum counter {
 };
 int counter_no_of_values = end_of_counter_enum;
 
+// DEFINE SCAN PROFILER SECTIONS ***********************************************
+
+enum profiler_section {
+  profile_emergency, //
+  profile_temperature, //
+  profile_error_monitor, //
+  profile_touch, //
+  profile_display, //
+  profile_steps, //
+  profile_reset, //
+  profile_sensors, //
+  profile_scan, // whole loop
+  end_of_profiler_enum // keep this entry
+};
+const char *const profiler_section_names[] = {"EMERGENCY", "TEMPERATURE", "ERRORS", "TOUCH", "DISPLAY",
+                                              "STEPS",     "RESET",       "SENSORS", "SCAN"};
+
 // DEFINE PINS / GENERATE OBJECTS ************************************************************
 
 EEPROM_Counter counter;
 State_controller state_controller;
+Step_timer step_timer;
 
 // INPUT PINS:
 const byte PRESSURE_SENSOR_PIN = CONTROLLINO_A3;
@@ -88,6 +113,23 @@ Debounce sensor_messerzylinder(CONTROLLINO_A9);
 Debounce hydraulic_safety_sensor_1(CONTROLLINO_A11); //
 Debounce hydraulic_safety_sensor_2(CONTROLLINO_A12); //
 
+// EDGES CAPTURED BY INTERRUPT:
+Input_capture input_capture(5); // [ms] stable time of an edge
+const byte CAPTURE_FOERDERZYLINDER_IN = input_capture.add_input(CONTROLLINO_A7);
+const byte CAPTURE_SLEDGE_ENDPOSITION = input_capture.add_input(CONTROLLINO_A5);
+const byte CAPTURE_MESSERZYLINDER = input_capture.add_input(CONTROLLINO_A9);
+const byte CAPTURE_FOERDERZYLINDER_OUT = input_capture.add_input(CONTROLLINO_A6);
+
+#ifdef TRACE_INPUTS
+// INPUTS RECORDED FOR THE REPLAY BY THE NATIVE SIMULATION:
+const byte trace_digital_pins[] = {CONTROLLINO_A4, CONTROLLINO_A5, CONTROLLINO_A7,  CONTROLLINO_A6,
+                                   CONTROLLINO_A10, CONTROLLINO_A0, CONTROLLINO_A1,  CONTROLLINO_A8,
+                                   CONTROLLINO_A9, CONTROLLINO_A11, CONTROLLINO_A12};
+const byte trace_analog_pins[] = {CONTROLLINO_A3, CONTROLLINO_A2}; // pressure, temperature
+Input_trace input_trace(trace_digital_pins, sizeof(trace_digital_pins), trace_analog_pins,
+                        sizeof(trace_analog_pins), 100);
+#endif
+
 // OUTPUT PINS:
 const byte FOERDERZYLINDER_LOGIC_POWER_RELAY = CONTROLLINO_R6; // WHITE // turn on >=50ms after start of "load voltage"
 const byte TRENNRELAIS_ZYLINDER_1 = CONTROLLINO_R4; // turn off >=100ms before logic power off
@@ -95,6 +137,38 @@ const byte TRENNRELAIS_ZYLINDER_2 = CONTROLLINO_R5; // turn off >=100ms before l
 const byte FOERDERZYLINDER_MOVE_IN = CONTROLLINO_D9; // GREY
 const byte FOERDERZYLINDER_MOVE_OUT = CONTROLLINO_D10; // PINK
 const byte TEMP_SENSOR_PIN = CONTROLLINO_A2;
+Electrocylinder electrocylinder(FOERDERZYLINDER_LOGIC_POWER_RELAY, TRENNRELAIS_ZYLINDER_1, TRENNRELAIS_ZYLINDER_2,
+                                FOERDERZYLINDER_MOVE_IN, FOERDERZYLINDER_MOVE_OUT);
+
+// ANALOG INPUTS SAMPLED BY INTERRUPT (DO NOT USE analogRead()):
+Analog_acquisition analog_acquisition;
+const byte ADC_PRESSURE = analog_acquisition.add_input(PRESSURE_SENSOR_PIN);
+const byte ADC_TEMPERATURE = analog_acquisition.add_input(TEMP_SENSOR_PIN);
+#ifdef TRACE_INPUTS
+int read_acquired_analog_input(uint8_t pin) { return analog_acquisition.get_value_of_pin(pin); }
+#endif
+
+// SENSOR CONVERSIONS (CALIBRATION TABLES IN EEPROM AFTER THE COUNTER VALUES):
+constexpr double volts_per_adc_unit = 0.03; // Controllino datasheet
+constexpr double pressure_sensor_max_voltage = 10; // Sensor datasheet
+constexpr double pressure_sensor_max_pressure = 10; // [barg]
+constexpr double cylinder_area = 15080; // [mm^2] measured from CAD, both cylinders without rod
+constexpr double force_per_adc_unit = volts_per_adc_unit / pressure_sensor_max_voltage * // [N]
+                                      pressure_sensor_max_pressure * cylinder_area / 10; // [bar] to [N/mm^2]
+constexpr double temperature_sensor_max_voltage = 10; // min voltage = 0 V
+constexpr double temperature_sensor_max_temperature = 200; // range @ WAGO 857-810: 0-200°C
+constexpr double degrees_per_adc_unit =
+    volts_per_adc_unit / temperature_sensor_max_voltage * temperature_sensor_max_temperature;
+constexpr Fixed_point_scale force_scale = make_fixed_point_scale(force_per_adc_unit, 1023);
+constexpr Fixed_point_scale temperature_scale = make_fixed_point_scale(degrees_per_adc_unit, 1023);
+const int calibration_eeprom_address = 1024;
+Sensor_conversion force_conversion(force_scale, calibration_eeprom_address);
+Sensor_conversion temperature_conversion(temperature_scale,
+                                         calibration_eeprom_address + SENSOR_CONVERSION_EEPROM_SIZE);
+
+// FORCE CURVE OF EVERY TENSION STROKE, ONE SAMPLE EVERY 10ms, SENT TO THE LOG:
+const bool log_force_curve = true; // false: send the features only
+Force_profile force_profile(10, log_force_curve);
 Cylinder cylinder_kuehlluft(CONTROLLINO_D13);
 Cylinder cylinder_schlittenzuluft(CONTROLLINO_D4);
 Cylinder cylinder_schlittenabluft(CONTROLLINO_R8);
@@ -111,7 +185,9 @@ Cylinder cylinder_hydr_vorschubklemme(CONTROLLINO_D6);
 Cylinder cylinder_hydr_power_supply(CONTROLLINO_D11);
 
 Insomnia nex_reset_button_timeout(10000); // pushtime to reset counter
+#ifdef PRINT_DEBUG_INFO
 Insomnia print_interval_timeout(1000);
+#endif
 Insomnia erase_force_value_timeout(5000);
 Insomnia log_force_value_timeout(1000);
 Insomnia machine_stopped_error_timeout(7000); // electrocylinder takes up to 20" to find start position
@@ -122,10 +198,25 @@ Insomnia pressure_update_delay;
 Insomnia temperature_update_delay;
 Insomnia cycle_step_delay;
 
+// SEND ONE SUMMARY PER LOOP SECTION TO SERIAL1 EVERY 10 SECONDS:
+Scan_profiler scan_profiler(profiler_section_names, end_of_profiler_enum, 10000);
+
+// COOPERATIVE TASKS (NON BLOCKING SEQUENCES):
+Coop_task reset_task; // reset rig, let hydraulics move back, stroke wippenhebel
+Coop_task stop_task; // reset rig, stroke wippenhebel, shut down air and electrocylinder
+Coop_task timeout_recovery_task; // show timeout info, then reset or stop rig
+
 // GLOBAL VARIABLES: -----------------------------------------------------------
 unsigned long cycle_start_millis = millis();
 char reset_count = 0; // to monitor how many resets have been made
 char strap_count_for_knife = 0; // only cut strap every n times
+const char *stop_message = ""; // shown when the stop task has completed
+
+// TRAVEL TIMES [ms] from the start of a move to its captured sensor edge:
+unsigned long travel_time_foerderzylinder = 0;
+unsigned long travel_time_messer = 0; // 0 if the knife did not cut
+unsigned long travel_time_sledge = 0;
+Small_string<48> travel_times_line; // record of the last cycle, empty when sent
 
 // LOGS AND EMAILS: ------------------------------------------------------------
 
@@ -149,6 +240,43 @@ void send_log_force_tension(long value) {
   }
 }
 
+void clear_travel_times() {
+  travel_time_foerderzylinder = 0;
+  travel_time_messer = 0;
+  travel_time_sledge = 0;
+}
+
+// Records of a cycle, taken when the cycle wraps back to step 0 and sent by
+// send_log_cycle_records() without blocking the loop:
+// LOG;STEP_TIMES;... (see step_timer.h)
+// LOG;TRAVEL_TIMES;<foerderzylinder>,<messer>,<sledge>;<lost edges>; [ms]
+void close_cycle_records() {
+  step_timer.close_cycle();
+  travel_times_line.clear();
+  travel_times_line.print("LOG;TRAVEL_TIMES;");
+  travel_times_line.print(travel_time_foerderzylinder);
+  travel_times_line.print(",");
+  travel_times_line.print(travel_time_messer);
+  travel_times_line.print(",");
+  travel_times_line.print(travel_time_sledge);
+  travel_times_line.print(";");
+  travel_times_line.print(input_capture.get_lost_edges());
+  travel_times_line.print(";\r\n");
+  clear_travel_times();
+}
+
+void send_log_cycle_records() {
+  step_timer.send_record(Serial1);
+  if (travel_times_line.length() && Serial1.availableForWrite() >= travel_times_line.length()) {
+    Serial1.print(travel_times_line.c_str());
+    travel_times_line.clear();
+  }
+}
+
+unsigned long get_travel_time(byte capture_channel, unsigned long start_micros) {
+  return (input_capture.get_rising_edge_micros(capture_channel) - start_micros) / 1000;
+}
+
 void send_log_start_tensioning() { //
   Serial1.println("LOG;START_TENSION;");
 }
@@ -167,81 +295,73 @@ void send_email_button_pushed() { //
 
 // NEXTION DISPLAY OBJECTS *****************************************************
 
-// PAGE 0 ----------------------------------------------------------------------
-NexPage nex_page_0 = NexPage(0, 0, "page0");
-// PAGE 1 - LEFT SIDE ----------------------------------------------------------
-NexPage nex_page_1 = NexPage(1, 0, "page1");
-NexButton button_previous_step = NexButton(1, 6, "b1");
-NexButton button_next_step = NexButton(1, 7, "b2");
-NexButton button_reset_rig = NexButton(1, 5, "b0");
-NexDSButton switch_play_pause = NexDSButton(1, 3, "bt0");
-NexDSButton switch_step_auto_mode = NexDSButton(1, 4, "bt1");
-// PAGE 1 - RIGHT SIDE ---------------------------------------------------------
-// NexButton button_spanntaste = NexButton(1, 9, "b4");
-// NexButton button_crimptaste = NexButton(1, 8, "b3");
-NexButton button_schneiden = NexButton(1, 14, "b5");
-NexButton button_schlitten = NexButton(1, 1, "b6");
-NexDSButton switch_vorklemme = NexDSButton(1, 16, "bt2");
-NexDSButton switch_nachklemme = NexDSButton(1, 17, "bt4");
-NexDSButton switch_wippenhebel = NexDSButton(1, 10, "bt5");
-NexDSButton switch_entlueften = NexDSButton(1, 13, "bt3");
-// PAGE 2 - LEFT SIDE ----------------------------------------------------------
-NexPage nex_page_2 = NexPage(2, 0, "page2");
-NexButton button_slider_1_left = NexButton(2, 5, "b1");
-NexButton button_slider_1_right = NexButton(2, 6, "b2");
-NexButton button_slider_2_left = NexButton(2, 16, "b5");
-NexButton button_slider_2_right = NexButton(2, 17, "b6");
-
-// PAGE 2 - RIGHT SIDE ---------------------------------------------------------
-NexButton button_reset_shorttime_counter = NexButton(2, 12, "b4");
-
-// NEXTION DISPLAY - TOUCH EVENT LIST ******************************************
-
-NexTouch *nex_listen_list[] = { //
-    // PAGE 0:
-    &nex_page_0,
-    // PAGE 1 LEFT:
-    &nex_page_1, &button_previous_step, &button_next_step, &button_reset_rig, &switch_play_pause,
-    &switch_step_auto_mode,
-    // PAGE 1 RIGHT:
-    &button_schneiden, &switch_vorklemme, &switch_nachklemme, &switch_wippenhebel, &switch_entlueften,
-    &button_schlitten,
-    // PAGE 2 LEFT:
-    &nex_page_2, &button_slider_1_left, &button_slider_1_right, &nex_page_2, &button_slider_2_left,
-    &button_slider_2_right,
-    // PAGE 2 RIGHT:
-    &button_reset_shorttime_counter,
-    // END OF LISTEN LIST:
-    NULL};
+Nextion_queue nextion_queue; // all display output after setup goes through the queue
+const unsigned int nextion_bytes_per_second = 2000; // display budget, at most half of the link is used
+const char *const display_priority_names[] = {"SAFETY", "MODE", "PROCESS", "COSMETIC"};
+
+// FORCE CURVE WHILE TENSIONING, WAVEFORM COMPONENT ID 25 ON PAGE 1:
+// one point every 50ms, at most 400 bytes per second, 15080N (10 bar) at the top
+Waveform_stream force_waveform(25, 0, 50, 400, 15080);
 
 // VARIABLES TO MONITOR NEXTION DISPLAY STATES *********************************
 
-bool nex_state_schlittenabluft;
-// bool nex_state_spanntaste;
-// bool nex_state_crimptaste;
-bool nex_state_vorklemme;
-bool nex_state_nachklemme;
-bool nex_state_wippenhebel;
-bool nex_state_schlittenzuluft;
-bool nex_state_messer;
-bool nex_state_machine_running;
-bool nex_state_step_mode = true;
 byte nex_prev_cycle_step;
 byte nex_current_page = 0;
-long nex_cycle_duration;
-long nex_max_temperature;
-long nex_shorttime_counter;
-long nex_longtime_counter;
 int nex_prev_current_temperature;
 
-// CREATE VECTOR CONTAINER FOR THE CYCLE STEPS OBJECTS ************************
+// NEXTION DISPLAY - BINDINGS **************************************************
+
+long get_machine_is_running() { return state_controller.machine_is_running(); }
+long get_auto_mode_is_active() { return !state_controller.is_in_step_mode(); }
+long get_vorklemme_state() { return cylinder_hydr_vorklemme.get_state(); }
+long get_nachklemme_state() { return cylinder_hydr_nachklemme.get_state(); }
+long get_wippenhebel_state() { return cylinder_wippenhebel.get_state(); }
+long get_entlueften_state() { return !cylinder_schlittenabluft.get_state(); }
+long get_schlittenzuluft_state() { return cylinder_schlittenzuluft.get_state(); }
+long get_messer_state() { return cylinder_messer.get_state(); }
+long get_cycle_duration() { return counter.get_value(cycle_duration); }
+long get_max_temperature() { return counter.get_value(max_temperature); }
+long get_longtime_counter() { return counter.get_value(longtime_counter); }
+long get_shorttime_counter() { return counter.get_value(shorttime_counter); }
+
+// ONE ROW PER DISPLAY COMPONENT: {page, component, render kind, getter, suffix, priority}
+const Display_binding display_binding_table[] PROGMEM = {
+    // PAGE 1 LEFT:
+    {1, "bt0", render_ds_switch, get_machine_is_running, "", priority_mode}, //
+    {1, "bt1", render_ds_switch, get_auto_mode_is_active, "", priority_mode}, //
+    // PAGE 1 RIGHT:
+    {1, "bt2", render_ds_switch, get_vorklemme_state, "", priority_process}, //
+    {1, "bt4", render_ds_switch, get_nachklemme_state, "", priority_process}, //
+    {1, "bt5", render_ds_switch, get_wippenhebel_state, "", priority_process}, //
+    {1, "bt3", render_ds_switch, get_entlueften_state, "", priority_process}, //
+    {1, "b6", render_momentary, get_schlittenzuluft_state, "", priority_process}, //
+    {1, "b5", render_momentary, get_messer_state, "", priority_process}, //
+    // PAGE 2 LEFT:
+    {2, "t24", render_text, get_cycle_duration, " s", priority_cosmetic}, //
+    {2, "t22", render_text, get_max_temperature, " C", priority_cosmetic}, //
+    // PAGE 2 RIGHT:
+    {2, "t20", render_text, get_longtime_counter, "", priority_cosmetic}, //
+    {2, "t21", render_text, get_shorttime_counter, "", priority_cosmetic} //
+};
+Display_bindings display_bindings(display_binding_table,
+                                  sizeof(display_binding_table) / sizeof(display_binding_table[0]), 2);
+
+// CYCLE STEPS *****************************************************************
+// The step objects and the sequence table are defined after the step classes
 
 int Cycle_step::object_count = 0; // enable object counting
-std::vector<Cycle_step *> main_cycle_steps;
+unsigned long completed_steps_of_group; // one bit per step of the current group
 
 // NON NEXTION FUNCTIONS *******************************************************
 
-void reset_flag_of_current_step() { main_cycle_steps[state_controller.get_current_step()]->reset_flags(); }
+void reset_flag_of_current_step() {
+  int first_step = state_controller.get_current_step();
+  int last_step = state_controller.get_last_step_of_current_group();
+  for (int i = first_step; i <= last_step; i++) {
+    get_cycle_step(i)->reset_flags();
+  }
+  completed_steps_of_group = 0;
+}
 
 void foerderzylinder_zurueck() {
   digitalWrite(FOERDERZYLINDER_MOVE_OUT, HIGH);
@@ -263,12 +383,6 @@ void vent_sledge() {
   cylinder_schlittenabluft.set(0);
 }
 
-void stroke_wippenhebel() {
-  cylinder_wippenhebel.set(1);
-  delay(500);
-  cylinder_wippenhebel.set(0);
-}
-
 void reset_pneumatics() {
   cylinder_messer.set(0);
   cylinder_schlittenzuluft.set(0);
@@ -286,17 +400,20 @@ void reset_hydraulics() {
   cylinder_hydr_vorklemme.set(0);
   cylinder_hydr_nachklemme.set(0);
   cylinder_hydr_vorschubklemme.set(0);
-  delay(1000); // time for Hydraulic cylinders to move back
+  // reset and stop task wait for hydraulic cylinders to move back
 }
 
 void reset_machine_states() {
   state_controller.set_machine_stop();
   state_controller.set_error_mode(false);
+  step_timer.stop_timing();
+  step_timer.clear_durations(); // the aborted cycle is not logged
+  clear_travel_times();
   reset_flag_of_current_step();
   state_controller.set_current_step_to(0);
   reset_flag_of_current_step();
-  clear_text_field("t4");
-  hide_info_field();
+  clear_text_field("t4", priority_mode);
+  hide_info_field(priority_mode);
 }
 
 void reset_electrocylinder() { //
@@ -310,21 +427,12 @@ void reset_machine() {
   }
   reset_machine_states();
   reset_pneumatics();
-  if (!digitalRead(FOERDERZYLINDER_LOGIC_POWER_RELAY)) {
-    // Logic has been powerded off
-    power_on_electrocylinder(); // 8s delay
-  }
+  // Starts the power on sequence if logic has been powered off:
+  electrocylinder.power_on();
   reset_electrocylinder();
   reset_hydraulics();
 }
 
-long measure_runtime() {
-  static long previous_micros = micros();
-  long time_elapsed = micros() - previous_micros;
-  previous_micros = micros();
-  return time_elapsed;
-}
-
 void move_sledge() {
   cylinder_schlittenzuluft.set(1);
   cylinder_schlittenabluft.set(1);
@@ -340,28 +448,23 @@ void block_sledge() {
 void display_force(int force) {
   if (nex_current_page == 1) {
     show_info_field();
-    String force_string = String(force);
-    String suffix = " N";
-    display_text_in_info_field(force_string + suffix);
+    Small_string<12> force_text;
+    force_text.print(force);
+    force_text.print(F(" N"));
+    display_text_in_info_field(force_text.c_str());
   }
 }
 
-float calculate_pressure_from_adc(float sensor_adc_value) {
-  static const float voltsPerUnit = 0.03; // Controllino datasheet
-  static const float max_sensor_voltage = 10; // Sensor datasheet
-  static const float max_sensor_pressure = 10; // [barg]
+int get_force() { return force_conversion.convert(analog_acquisition.get_value(ADC_PRESSURE)); }
 
-  float sensor_voltage = sensor_adc_value * voltsPerUnit;
-  float pressure = sensor_voltage / max_sensor_voltage * max_sensor_pressure;
-  float cylinder_area = 15080; // [mm^2] measured from CAD, both cylinders without rod
-  float float_force = cylinder_area * pressure / 10; // 10 to convert from [bar] to [N/mm^2]
-  return int(float_force);
-}
-
-int get_force() {
-  float sensor_adc_value = analogRead(PRESSURE_SENSOR_PIN);
-  int force = calculate_pressure_from_adc(sensor_adc_value);
-  return force;
+// Every acquired pressure value reaches the profile, independent of the scan time:
+void record_force_profile() {
+  int adc_value;
+  unsigned long value_micros;
+  while (analog_acquisition.read_recorded_value(adc_value, value_micros)) {
+    force_profile.add_value(force_conversion.convert(adc_value), value_micros);
+  }
+  force_profile.send_report(Serial1);
 }
 
 void measure_and_display_max_force() {
@@ -370,6 +473,7 @@ void measure_and_display_max_force() {
   static int previous_max_force;
 
   int force = get_force();
+  force_waveform.add_sample(force, nex_current_page == 1, nextion_queue);
 
   // Stop timers when force is rising:
   if (force > max_force) {
@@ -416,29 +520,18 @@ void measure_and_display_current_force() {
 
 // MEASURE AND DISPLAY TEMPERATURE *********************************************
 
-float calculate_temperature_from_adc(float sensor_adc_value) {
-  const float volts_per_unit = 0.03; // controllino datasheet
-  const float max_sensor_voltage = 10; // min voltage = 0 V
-  const float max_sensor_temp = 200; // range @ WAGO 857-810: 0-200°C
-
-  float sensor_voltage = sensor_adc_value * volts_per_unit;
-  float temperature = sensor_voltage / max_sensor_voltage * max_sensor_temp;
-  return int(temperature);
-}
-
-int get_temperature() {
-  float sensor_value = analogRead(TEMP_SENSOR_PIN);
-  int temperature = calculate_temperature_from_adc(sensor_value);
-
-  return temperature;
-}
+int get_temperature() { return temperature_conversion.convert(analog_acquisition.get_value(ADC_TEMPERATURE)); }
 
 void display_temperature() {
   // TODO: IF TEMPERATURE HAS CHANGED MORE THAN ONE DEGREE, UPDATE:
   if (nex_prev_current_temperature != get_temperature() && nex_current_page == 1) {
 
     if (temperature_update_delay.delay_time_is_up(500)) {
-      display_text_in_field("t = " + String(get_temperature()) + " C", "t10");
+      Small_string<16> temperature_text;
+      temperature_text.print(F("t = "));
+      temperature_text.print(get_temperature());
+      temperature_text.print(F(" C"));
+      display_text_in_field(temperature_text.c_str(), "t10", priority_cosmetic);
       nex_prev_current_temperature = get_temperature();
     }
   }
@@ -454,69 +547,59 @@ void send_to_nextion() {
 
 void update_display_counter() {
   long new_value = counter.get_value(longtime_counter);
-  Serial2.print("t0.txt=");
-  Serial2.print("\"");
-  Serial2.print(new_value);
-  Serial2.print("\"");
-  send_to_nextion();
+  nextion_queue.print("t0.txt=");
+  nextion_queue.print("\"");
+  nextion_queue.print(new_value);
+  nextion_queue.print("\"");
+  nextion_queue.end_command(priority_cosmetic);
 }
 
-void show_info_field() {
+void show_info_field(byte priority) {
   if (nex_current_page == 1) {
-    Serial2.print("vis t4,1");
-    send_to_nextion();
+    nextion_queue.print("vis t4,1");
+    nextion_queue.end_command(priority);
   }
 }
 
-void display_text_in_info_field(String text) {
-  Serial2.print("t4");
-  Serial2.print(".txt=");
-  Serial2.print("\"");
-  Serial2.print(text);
-  Serial2.print("\"");
-  send_to_nextion();
+void display_text_in_info_field(const char *text, byte priority) {
+  nextion_queue.print("t4");
+  nextion_queue.print(".txt=");
+  nextion_queue.print("\"");
+  nextion_queue.print(text);
+  nextion_queue.print("\"");
+  nextion_queue.end_command(priority);
 }
 
-void hide_info_field() {
+void hide_info_field(byte priority) {
   if (nex_current_page == 1) {
-    Serial2.print("vis t4,0");
-    send_to_nextion();
+    nextion_queue.print("vis t4,0");
+    nextion_queue.end_command(priority);
   }
 }
 
-void clear_text_field(String textField) {
-  Serial2.print(textField);
-  Serial2.print(".txt=");
-  Serial2.print("\"");
-  Serial2.print(""); // erase text
-  Serial2.print("\"");
-  send_to_nextion();
-}
-
-void display_value_in_field(int value, String valueField) {
-  Serial2.print(valueField);
-  Serial2.print(".val=");
-  Serial2.print(value);
-  send_to_nextion();
+void clear_text_field(const char *text_field, byte priority) {
+  nextion_queue.print(text_field);
+  nextion_queue.print(".txt=");
+  nextion_queue.print("\"");
+  nextion_queue.print(""); // erase text
+  nextion_queue.print("\"");
+  nextion_queue.end_command(priority);
 }
 
-void display_text_in_field(String text, String textField) {
-  Serial2.print(textField);
-  Serial2.print(".txt=");
-  Serial2.print("\"");
-  Serial2.print(text);
-  Serial2.print("\"");
-  send_to_nextion();
+void display_value_in_field(int value, const char *value_field, byte priority = priority_process) {
+  nextion_queue.print(value_field);
+  nextion_queue.print(".val=");
+  nextion_queue.print(value);
+  nextion_queue.end_command(priority);
 }
 
-void toggle_ds_switch(String button) {
-  Serial2.print("click " + button + ",1");
-  send_to_nextion();
-}
-
-void set_momentary_button_high_or_low(String button, bool state) {
-  Serial2.print("click " + button + "," + state);
-  send_to_nextion();
+void display_text_in_field(const char *text, const char *text_field, byte priority) {
+  nextion_queue.print(text_field);
+  nextion_queue.print(".txt=");
+  nextion_queue.print("\"");
+  nextion_queue.print(text);
+  nextion_queue.print("\"");
+  nextion_queue.end_command(priority);
 }
 
 // NEXTION TOUCH EVENT FUNCTIONS ***********************************************
@@ -525,7 +608,6 @@ void set_momentary_button_high_or_low(String button, bool state) {
 
 void switch_play_pause_push(void *ptr) {
   state_controller.toggle_machine_running_state();
-  nex_state_machine_running = !nex_state_machine_running;
   machine_stopped_error_timeout.reset_time();
   bandsensor_timeout.reset_time();
   bandbogen_timeout.reset_time();
@@ -533,7 +615,6 @@ void switch_play_pause_push(void *ptr) {
 
 void switch_step_auto_mode_push(void *ptr) {
   state_controller.toggle_step_auto_mode();
-  nex_state_step_mode = state_controller.is_in_step_mode();
 }
 
 void button_stepback_push(void *ptr) {
@@ -556,28 +637,24 @@ void button_reset_rig_push(void *ptr) {
   reset_count = 0;
   state_controller.set_reset_mode(true);
   state_controller.set_run_after_reset(0);
-  clear_text_field("t4"); // info field
-  hide_info_field();
+  clear_text_field("t4", priority_mode); // info field
+  hide_info_field(priority_mode);
 }
 
 // TOUCH EVENT FUNCTIONS PAGE 1 - RIGHT SIDE -----------------------------------
 
 void switch_wippenhebel_push(void *ptr) {
   cylinder_wippenhebel.toggle();
-  nex_state_wippenhebel = !nex_state_wippenhebel;
 }
 void switch_vorklemme_push(void *ptr) {
   cylinder_hydr_vorklemme.toggle();
-  nex_state_vorklemme = !nex_state_vorklemme;
 }
 void switch_nachklemme_push(void *ptr) {
   cylinder_hydr_nachklemme.toggle();
-  nex_state_nachklemme = !nex_state_nachklemme;
 }
 
 void switch_entlueften_push(void *ptr) {
   cylinder_schlittenabluft.toggle();
-  nex_state_schlittenabluft = !nex_state_schlittenabluft;
 }
 void button_schneiden_push(void *ptr) { cylinder_messer.set(1); }
 void button_schneiden_pop(void *ptr) { cylinder_messer.set(0); }
@@ -640,72 +717,127 @@ void page_0_push(void *ptr) { nex_current_page = 0; }
 
 void page_1_push(void *ptr) {
   nex_current_page = 1;
-  hide_info_field();
+  hide_info_field(priority_mode);
 
-  // REFRESH BUTTON STATES:
+  // REFRESH ALL DISPLAY ELEMENTS:
   nex_prev_cycle_step = !state_controller.get_current_step();
-  nex_state_step_mode = true;
-  nex_state_schlittenabluft = 1;
-  nex_state_wippenhebel = 0;
-  nex_state_vorklemme = 0;
-  nex_state_nachklemme = 0;
-  nex_state_schlittenzuluft = 0;
-  nex_state_messer = 0;
-  nex_state_machine_running = 0;
+  display_bindings.invalidate();
 }
 
 void page_2_push(void *ptr) {
   nex_current_page = 2;
-  update_field_values_page_2();
+  nex_prev_current_temperature = -1;
+  display_bindings.invalidate();
 }
 
-void update_field_values_page_2() {
-  nex_cycle_duration = counter.get_value(nex_cycle_duration) - 1;
-  nex_max_temperature = counter.get_value(nex_max_temperature) - 1;
-  nex_shorttime_counter = counter.get_value(nex_shorttime_counter) - 1;
-  nex_longtime_counter = counter.get_value(nex_longtime_counter) - 1;
-  nex_prev_current_temperature = -1;
+// DISPLAY EVENT HANDLERS ******************************************************
+
+// SORTED BY PAGE, THEN BY COMPONENT ID: {page, component id, push, pop}
+const Touch_binding touch_binding_table[] PROGMEM = {
+    // PAGE 0:
+    {0, 0, page_0_push, NULL}, // page0
+    // PAGE 1:
+    {1, 0, page_1_push, NULL}, // page1
+    {1, 1, button_schlitten_push, button_schlitten_pop}, // b6
+    {1, 3, switch_play_pause_push, NULL}, // bt0
+    {1, 4, switch_step_auto_mode_push, NULL}, // bt1
+    {1, 5, button_reset_rig_push, NULL}, // b0
+    {1, 6, button_stepback_push, NULL}, // b1
+    {1, 7, button_next_step_push, NULL}, // b2
+    {1, 10, switch_wippenhebel_push, NULL}, // bt5
+    {1, 13, switch_entlueften_push, NULL}, // bt3
+    {1, 14, button_schneiden_push, button_schneiden_pop}, // b5
+    {1, 16, switch_vorklemme_push, NULL}, // bt2
+    {1, 17, switch_nachklemme_push, NULL}, // bt4
+    // PAGE 2:
+    {2, 0, page_2_push, NULL}, // page2
+    {2, 5, button_upper_slider_left_push, NULL}, // b1
+    {2, 6, button_upper_slider_right_push, NULL}, // b2
+    {2, 12, button_reset_shorttime_counter_push, button_reset_shorttime_counter_pop}, // b4
+    {2, 16, button_lower_slider_left_push, NULL}, // b5
+    {2, 17, button_lower_slider_right_push, NULL} // b6
+};
+Touch_dispatcher touch_dispatcher(touch_binding_table, sizeof(touch_binding_table) / sizeof(touch_binding_table[0]));
+
+// DISPLAY SETUP ***************************************************************
+
+// The display starts with 9600 baud after every reset.
+// The fastest baud rate the display confirms is used, 9600 otherwise.
+const unsigned long nextion_default_baud_rate = 9600;
+const unsigned long nextion_baud_rates[] = {115200, 57600, 38400, 19200}; // fastest first
+const unsigned long nextion_answer_timeout = 100000; // [us]
+
+// Requests the current page ("sendme", answer 0x66 <page> 0xff 0xff 0xff).
+// Returns the round trip time [us], or -1 if the display did not answer:
+long measure_nextion_round_trip() {
+  while (Serial2.available()) {
+    Serial2.read();
+  }
+  unsigned long start_micros = micros();
+  Serial2.print("sendme");
+  send_to_nextion();
+
+  byte bytes_received = 0;
+  while (micros() - start_micros < nextion_answer_timeout) {
+    if (!Serial2.available()) {
+      delayMicroseconds(50);
+      continue;
+    }
+    byte c = Serial2.read();
+    if (bytes_received == 0 && c != 0x66) {
+      continue;
+    }
+    if (++bytes_received == 5) {
+      return micros() - start_micros;
+    }
+  }
+  return -1;
 }
 
-// DECLARE DISPLAY EVENT LISTENERS *********************************************
-
-void attach_push_and_pop() {
-  // PAGE 0 PUSH ONLY:
-  nex_page_0.attachPush(page_0_push);
-  // PAGE 1 PUSH ONLY:
-  nex_page_1.attachPush(page_1_push);
-  button_previous_step.attachPush(button_stepback_push);
-  button_next_step.attachPush(button_next_step_push);
-  button_reset_rig.attachPush(button_reset_rig_push);
-  button_previous_step.attachPush(button_stepback_push);
-  button_next_step.attachPush(button_next_step_push);
-  switch_play_pause.attachPush(switch_play_pause_push);
-  switch_step_auto_mode.attachPush(switch_step_auto_mode_push);
-  switch_vorklemme.attachPush(switch_vorklemme_push);
-  switch_nachklemme.attachPush(switch_nachklemme_push);
-  switch_wippenhebel.attachPush(switch_wippenhebel_push);
-  switch_entlueften.attachPush(switch_entlueften_push);
-  // PAGE 1 PUSH AND POP:
-  button_schneiden.attachPush(button_schneiden_push);
-  button_schneiden.attachPop(button_schneiden_pop);
-  button_schlitten.attachPush(button_schlitten_push);
-  button_schlitten.attachPop(button_schlitten_pop);
-  // PAGE 2 PUSH ONLY:
-  nex_page_2.attachPush(page_2_push);
-  button_slider_1_left.attachPush(button_upper_slider_left_push);
-  button_slider_1_right.attachPush(button_upper_slider_right_push);
-  button_slider_2_left.attachPush(button_lower_slider_left_push);
-  button_slider_2_right.attachPush(button_lower_slider_right_push);
-  // PAGE 2 PUSH AND POP:
-  button_reset_shorttime_counter.attachPush(button_reset_shorttime_counter_push);
-  button_reset_shorttime_counter.attachPop(button_reset_shorttime_counter_pop);
+void switch_nextion_baud_rate(unsigned long baud_rate) {
+  Serial2.print("baud=");
+  Serial2.print(baud_rate);
+  send_to_nextion();
+  Serial2.flush(); // the command has to leave with the old baud rate
+  delay(50); // give the display time to switch
+  Serial2.begin(baud_rate);
 }
 
-// DISPLAY SETUP ***************************************************************
+void negotiate_nextion_baud_rate() {
+  unsigned long baud_rate = nextion_default_baud_rate;
+  long round_trip = -1;
+
+  for (byte i = 0; i < sizeof(nextion_baud_rates) / sizeof(nextion_baud_rates[0]); i++) {
+    switch_nextion_baud_rate(nextion_baud_rates[i]);
+    round_trip = measure_nextion_round_trip();
+    if (round_trip >= 0) {
+      baud_rate = nextion_baud_rates[i];
+      break;
+    }
+    // NO ANSWER, MAKE SURE THE DISPLAY IS BACK ON THE DEFAULT BAUD RATE:
+    switch_nextion_baud_rate(nextion_default_baud_rate);
+    send_to_nextion(); // clear a command garbled by the wrong baud rate
+  }
+  if (round_trip < 0) {
+    round_trip = measure_nextion_round_trip();
+  }
+
+  Serial.print("NEXTION BAUD RATE: ");
+  Serial.println(baud_rate);
+  Serial.print("NEXTION ROUND TRIP [us]: ");
+  if (round_trip >= 0) {
+    Serial.println(round_trip);
+  } else {
+    Serial.println("NO ANSWER");
+  }
+
+  // A BAUD RATE OF 9600 SENDS 960 BYTES PER SECOND:
+  nextion_queue.set_bytes_per_second(min(nextion_bytes_per_second, (unsigned int)(baud_rate / 20)));
+}
 
 void nextion_display_setup() {
 
-  Serial2.begin(9600);
+  Serial2.begin(nextion_default_baud_rate);
 
   // RESET NEXTION DISPLAY: (refresh display after PLC restart)
   send_to_nextion(); // needed to start communication
@@ -713,9 +845,9 @@ void nextion_display_setup() {
   send_to_nextion();
   sendCommand("page 0");
   send_to_nextion();
-  attach_push_and_pop();
 
   delay(3000);
+  negotiate_nextion_baud_rate();
   sendCommand("page 1"); // switch display to page x
   send_to_nextion();
 }
@@ -724,38 +856,39 @@ void nextion_display_setup() {
 
 void nextion_display_loop() {
   //****************************************************************************
-  nexLoop(nex_listen_list); // check for any touch event
+  touch_dispatcher.receive_events(Serial2); // check for any touch event
+  scan_profiler.measure_section(profile_touch);
 
   if (nex_current_page == 1) {
-    display_loop_page_1_left_side();
-    display_loop_page_1_right_side();
+    update_cycle_name();
   }
 
   if (nex_current_page == 2) {
-    display_loop_page_2_left_side();
-    display_loop_page_2_right_side();
+    reset_lower_counter_value();
   }
-}
 
-// DISPLAY LOOP PAGE 1 LEFT SIDE: -----------------------------------------------
+  // REFRESH A FEW OF THE BOUND COMPONENTS OF THE CURRENT PAGE:
+  display_bindings.update(nex_current_page, nextion_queue);
 
-void display_loop_page_1_left_side() {
-
-  update_cycle_name();
-
-  // UPDATE SWITCHSTATE "STEP"/"AUTO"-MODE:
-  if (nex_state_step_mode != state_controller.is_in_step_mode()) {
-    toggle_ds_switch("bt1");
-    nex_state_step_mode = state_controller.is_in_step_mode();
-  }
+  // SEND AS MANY QUEUED COMMANDS AS FIT INTO THE TX BUFFER:
+  nextion_queue.send_commands(Serial2);
 }
 
+// DISPLAY LOOP PAGE 1: --------------------------------------------------------
+
 void update_main_cycle_name() {
   if (nex_prev_cycle_step != state_controller.get_current_step()) {
-    String number = String(state_controller.get_current_step() + 1);
-    String name = get_main_cycle_display_string();
-    Serial.println(number + " " + name);
-    display_text_in_field(number + " " + name, "t0");
+    int number = state_controller.get_current_step() + 1;
+    const __FlashStringHelper *name = get_cycle_step(state_controller.get_current_step())->get_display_text();
+    Serial.print(number);
+    Serial.print(" ");
+    Serial.println(name);
+    nextion_queue.print("t0.txt=\"");
+    nextion_queue.print(number);
+    nextion_queue.print(" ");
+    nextion_queue.print(name);
+    nextion_queue.print("\"");
+    nextion_queue.end_command(priority_mode);
     nex_prev_cycle_step = state_controller.get_current_step();
   }
 }
@@ -766,109 +899,7 @@ void update_cycle_name() {
   }
 }
 
-String get_main_cycle_display_string() {
-  int current_step = state_controller.get_current_step();
-  String display_text_cycle_name = main_cycle_steps[current_step]->get_display_text();
-  return display_text_cycle_name;
-}
-
-// DISPLAY LOOP PAGE 1 RIGHT SIDE: ---------------------------------------------
-
-void display_loop_page_1_right_side() {
-
-  // UPDATE SWITCHES:
-  if (state_controller.machine_is_running() != nex_state_machine_running) {
-    toggle_ds_switch("bt0");
-    nex_state_machine_running = !nex_state_machine_running;
-  }
-  if (cylinder_schlittenabluft.get_state() != nex_state_schlittenabluft) {
-    toggle_ds_switch("bt3");
-    nex_state_schlittenabluft = !nex_state_schlittenabluft;
-  }
-  if (cylinder_wippenhebel.get_state() != nex_state_wippenhebel) {
-    toggle_ds_switch("bt5");
-    nex_state_wippenhebel = !nex_state_wippenhebel;
-  }
-  if (cylinder_hydr_vorklemme.get_state() != nex_state_vorklemme) {
-    toggle_ds_switch("bt2");
-    nex_state_vorklemme = !nex_state_vorklemme;
-  }
-  if (cylinder_hydr_nachklemme.get_state() != nex_state_nachklemme) {
-    toggle_ds_switch("bt4");
-    nex_state_nachklemme = !nex_state_nachklemme;
-  }
-
-  // UPDATE BUTTONS:
-  if (cylinder_schlittenzuluft.get_state() != nex_state_schlittenzuluft) {
-    bool state = cylinder_schlittenzuluft.get_state();
-    String button = "b6";
-    set_momentary_button_high_or_low(button, state);
-    nex_state_schlittenzuluft = cylinder_schlittenzuluft.get_state();
-  }
-
-  if (cylinder_messer.get_state() != nex_state_messer) {
-    bool state = cylinder_messer.get_state();
-    String button = "b5";
-    set_momentary_button_high_or_low(button, state);
-    nex_state_messer = cylinder_messer.get_state();
-  }
-}
-
-// DIPLAY LOOP PAGE 2 LEFT SIDE: -----------------------------------------------
-
-void display_loop_page_2_left_side() {
-  update_upper_slider_value();
-  update_lower_slider_value();
-  update_switches_page_2_left();
-
-  // UPDATE SWITCH:
-}
-
-void update_upper_slider_value() {
-  if (counter.get_value(cycle_duration) != nex_cycle_duration) {
-    display_text_in_field(add_suffix_to_eeprom_value(cycle_duration, "s"), "t24");
-    nex_cycle_duration = counter.get_value(cycle_duration);
-  }
-}
-
-void update_lower_slider_value() {
-  if (counter.get_value(max_temperature) != nex_max_temperature) {
-    display_text_in_field(add_suffix_to_eeprom_value(max_temperature, " C"), "t22");
-    nex_max_temperature = counter.get_value(max_temperature);
-  }
-}
-
-String add_suffix_to_eeprom_value(int eeprom_value_number, String suffix) {
-  String value = String(counter.get_value(eeprom_value_number));
-  String space = " ";
-  String suffixed_string = value + space + suffix;
-  return suffixed_string;
-}
-
-void update_switches_page_2_left() {}
-
-// DIPLAY LOOP PAGE 2 RIGHT SIDE: ----------------------------------------------
-
-void display_loop_page_2_right_side() {
-  update_upper_counter_value();
-  update_lower_counter_value();
-  reset_lower_counter_value();
-}
-
-void update_upper_counter_value() {
-  if (nex_longtime_counter != counter.get_value(longtime_counter)) {
-    display_text_in_field(String(counter.get_value(longtime_counter)), "t20");
-    nex_longtime_counter = counter.get_value(longtime_counter);
-  }
-}
-
-void update_lower_counter_value() {
-  // UPDATE LOWER COUNTER:
-  if (nex_shorttime_counter != counter.get_value(shorttime_counter)) {
-    display_text_in_field(String(counter.get_value(shorttime_counter)), "t21");
-    nex_shorttime_counter = counter.get_value(shorttime_counter);
-  }
-}
+// DISPLAY LOOP PAGE 2: --------------------------------------------------------
 
 void reset_lower_counter_value() {
   if (nex_reset_button_timeout.is_marked_activated()) {
@@ -883,11 +914,13 @@ void reset_lower_counter_value() {
 
 // SCHLITTEN ENTLÜFTEN
 class Luft_ablassen : public Cycle_step {
-  String get_display_text() { return "LUFT ABLASSEN"; }
+  const __FlashStringHelper *get_display_text() { return F("LUFT ABLASSEN"); }
   bool pressure_low = false;
 
   void do_initial_stuff() {
     vent_sledge();
+    force_waveform.stop();
+    force_waveform.clear(nextion_queue);
     pressure_low = false;
     cycle_step_delay.set_unstarted();
     cycle_start_millis = millis();
@@ -907,7 +940,7 @@ class Luft_ablassen : public Cycle_step {
 
 // VORKLEMME ÖFFNEN
 class Vorklemme_auf : public Cycle_step {
-  String get_display_text() { return "VORKLEMME AUF"; }
+  const __FlashStringHelper *get_display_text() { return F("VORKLEMME AUF"); }
 
   void do_initial_stuff() {
     cylinder_hydr_vorklemme.set(0);
@@ -922,7 +955,7 @@ class Vorklemme_auf : public Cycle_step {
 
 // SCHLITTEN ZURÜCKFAHREN
 class Schlitten_zurueck : public Cycle_step {
-  String get_display_text() { return "SCHLITTEN ZURUECK"; }
+  const __FlashStringHelper *get_display_text() { return F("SCHLITTEN ZURUECK"); }
 
   void do_initial_stuff() { move_sledge(); }
   void do_loop_stuff() {
@@ -935,14 +968,15 @@ class Schlitten_zurueck : public Cycle_step {
 
 // NACHKLEMME ÖFFNEN
 class Nachklemme_auf : public Cycle_step {
-  String get_display_text() { return "NACHKLEMME AUF"; }
+  const __FlashStringHelper *get_display_text() { return F("NACHKLEMME AUF"); }
+  Insomnia step_delay; // runs parallel to other steps
 
   void do_initial_stuff() {
     cylinder_hydr_nachklemme.set(0);
-    cycle_step_delay.set_unstarted();
+    step_delay.set_unstarted();
   }
   void do_loop_stuff() {
-    if (cycle_step_delay.delay_time_is_up(200)) {
+    if (step_delay.delay_time_is_up(200)) {
       set_loop_completed();
     }
   }
@@ -950,7 +984,7 @@ class Nachklemme_auf : public Cycle_step {
 
 // AUSWERFER BETÄTIGEN
 class Auswerfen : public Cycle_step {
-  String get_display_text() { return "AUSWERFEN"; }
+  const __FlashStringHelper *get_display_text() { return F("AUSWERFEN"); }
 
   void do_initial_stuff() {}
   void do_loop_stuff() {
@@ -961,14 +995,15 @@ class Auswerfen : public Cycle_step {
 
 // FÖRDERKLEMME SCHLIESSEN
 class Foerderklemme_zu : public Cycle_step {
-  String get_display_text() { return "FOERDERKLEMME ZU"; }
+  const __FlashStringHelper *get_display_text() { return F("FOERDERKLEMME ZU"); }
+  Insomnia step_delay; // runs parallel to other steps
 
   void do_initial_stuff() {
     cylinder_hydr_vorschubklemme.set(1);
-    cycle_step_delay.set_unstarted();
+    step_delay.set_unstarted();
   }
   void do_loop_stuff() {
-    if (cycle_step_delay.delay_time_is_up(800)) {
+    if (step_delay.delay_time_is_up(800)) {
       set_loop_completed();
     }
   }
@@ -976,14 +1011,18 @@ class Foerderklemme_zu : public Cycle_step {
 
 // FÖRDERN
 class Foerdern : public Cycle_step {
-  String get_display_text() { return "FOERDERN"; }
+  const __FlashStringHelper *get_display_text() { return F("FOERDERN"); }
+  unsigned long start_micros = 0;
 
   void do_initial_stuff() {
+    input_capture.clear_edges(CAPTURE_FOERDERZYLINDER_IN);
+    start_micros = micros();
     foerderzylinder_foerdern();
     machine_stopped_error_timeout.set_time(25000);
   }
   void do_loop_stuff() {
-    if (sensor_foerderzylinder_in.switched_high()) {
+    if (input_capture.switched_high(CAPTURE_FOERDERZYLINDER_IN)) {
+      travel_time_foerderzylinder = get_travel_time(CAPTURE_FOERDERZYLINDER_IN, start_micros);
       machine_stopped_error_timeout.reset_time();
       machine_stopped_error_timeout.set_time(7000);
       set_loop_completed();
@@ -993,7 +1032,7 @@ class Foerdern : public Cycle_step {
 
 // VORKLEMME SCHLIESSEN
 class Vorklemme_zu : public Cycle_step {
-  String get_display_text() { return "VORKLEMME ZU"; }
+  const __FlashStringHelper *get_display_text() { return F("VORKLEMME ZU"); }
 
   void do_initial_stuff() {
     cylinder_hydr_vorklemme.set(1);
@@ -1009,24 +1048,48 @@ class Vorklemme_zu : public Cycle_step {
 // MESSER AB
 
 class Schneiden : public Cycle_step {
-  String get_display_text() { return "SCHNEIDEN"; }
+  const __FlashStringHelper *get_display_text() { return F("SCHNEIDEN"); }
   int cut_retries = 0;
+  bool knife_is_retracting = false;
+  bool strap_is_cut = false;
+  unsigned long stroke_start_micros = 0;
 
   void do_initial_stuff() {
     cut_retries = 0;
+    knife_is_retracting = false;
+    strap_is_cut = false;
     vent_sledge();
+    input_capture.clear_edges(CAPTURE_MESSERZYLINDER);
+    stroke_start_micros = micros();
+    cycle_step_delay.set_unstarted();
+  }
+
+  void retract_knife() {
+    cylinder_messer.set(0);
+    knife_is_retracting = true;
     cycle_step_delay.set_unstarted();
   }
 
   void try_cutting_twice() {
+    // Give the knife time to retract without blocking the loop:
+    if (knife_is_retracting) {
+      if (cycle_step_delay.delay_time_is_up(500)) {
+        knife_is_retracting = false;
+        stroke_start_micros = micros(); // of the next stroke
+        if (strap_is_cut) {
+          set_loop_completed();
+        }
+      }
+      return;
+    }
+
     cylinder_messer.stroke(1000, 500);
 
     // If sensor does not switch high during the set stroke time,
     // knife did not cut through and a second stroke will be started.
     if (cylinder_messer.stroke_completed()) {
       cut_retries++;
-      cylinder_messer.set(0);
-      delay(500);
+      retract_knife();
     }
 
     if (cut_retries == 3) {
@@ -1036,12 +1099,12 @@ class Schneiden : public Cycle_step {
       error_stop_machine("ERROR MESSER");
     }
 
-    if (sensor_messerzylinder.switched_high()) {
+    if (input_capture.switched_high(CAPTURE_MESSERZYLINDER)) {
+      travel_time_messer = get_travel_time(CAPTURE_MESSERZYLINDER, stroke_start_micros);
       strap_count_for_knife = 0;
       cylinder_messer.abort_stroke();
-      cylinder_messer.set(0);
-      delay(500);
-      set_loop_completed();
+      strap_is_cut = true;
+      retract_knife();
     }
   }
   void do_loop_stuff() {
@@ -1059,7 +1122,7 @@ class Schneiden : public Cycle_step {
 
 // FÖRDERKLEMME ÖFFNEN
 class Foerdereinheit_auf : public Cycle_step {
-  String get_display_text() { return "FOERDERKLEMME AUF"; }
+  const __FlashStringHelper *get_display_text() { return F("FOERDERKLEMME AUF"); }
 
   void do_initial_stuff() {
     cylinder_hydr_vorschubklemme.set(0);
@@ -1074,25 +1137,23 @@ class Foerdereinheit_auf : public Cycle_step {
 
 // FÖRDERZYLINDER ZURÜCK
 class Foerderzylinder_zurueck : public Cycle_step {
-  String get_display_text() { return "FOERDERER ZURUECK"; }
+  const __FlashStringHelper *get_display_text() { return F("FOERDERER ZURUECK"); }
+  Settle_time settle_time = Settle_time(500, 50); // [ms] max settle time, safety margin
+
+  Settle_time *get_settle_time() { return &settle_time; }
+  // Only an edge after the start is learned, a sensor that is already high would teach about 0ms:
+  bool sensor_has_confirmed() { return input_capture.switched_high(CAPTURE_FOERDERZYLINDER_OUT); }
 
   void do_initial_stuff() {
+    input_capture.clear_edges(CAPTURE_FOERDERZYLINDER_OUT);
     foerderzylinder_zurueck();
-    cycle_step_delay.set_unstarted();
-  }
-  void do_loop_stuff() {
-    // if (sensor_foerderzylinder_out.switched_high()) {
-    //   set_loop_completed();
-    // }
-    if (cycle_step_delay.delay_time_is_up(500)) {
-      set_loop_completed();
-    }
   }
+  void do_loop_stuff() {}
 };
 
 // AUSWERFER ZURÜCK
 class Auswerfer_zurueck : public Cycle_step {
-  String get_display_text() { return "AUSWERFER ZURUECK"; }
+  const __FlashStringHelper *get_display_text() { return F("AUSWERFER ZURUECK"); }
 
   void do_initial_stuff() { vent_sledge(); }
   void do_loop_stuff() {
@@ -1103,7 +1164,7 @@ class Auswerfer_zurueck : public Cycle_step {
 
 // // MESSER AUF
 // class Messer_auf : public Cycle_step {
-//   String get_display_text() { return "MESSER AUF"; }
+//   const __FlashStringHelper *get_display_text() { return F("MESSER AUF"); }
 
 //   void do_initial_stuff() {
 //     vent_sledge();
@@ -1119,7 +1180,7 @@ class Auswerfer_zurueck : public Cycle_step {
 
 // WIPPENHEBEL SCHLIESSEN
 class Tool_wippe_zu : public Cycle_step {
-  String get_display_text() { return "WIPPE ZU"; }
+  const __FlashStringHelper *get_display_text() { return F("WIPPE ZU"); }
 
   void do_initial_stuff() {
     cylinder_wippenhebel.set(0);
@@ -1136,21 +1197,26 @@ class Tool_wippe_zu : public Cycle_step {
 
 // MIT FÖRDERZYLINDER AKTIV SPANNEN UM BOGEN ZU VERMEIDEN
 class Aktiv_spannen : public Cycle_step {
-  String get_display_text() { return "AKTIV SPANNEN"; }
+  const __FlashStringHelper *get_display_text() { return F("AKTIV SPANNEN"); }
   void do_initial_stuff() { foerderzylinder_foerdern(); }
   void do_loop_stuff() { set_loop_completed(); }
 };
 
 // GERÄT SPANNEN
 class Tool_spannen : public Cycle_step {
-  String get_display_text() { return "TOOL SPANNEN"; }
+  const __FlashStringHelper *get_display_text() { return F("TOOL SPANNEN"); }
   bool has_reached_sensor = false;
+  unsigned long start_micros = 0;
 
   void do_initial_stuff() {
     has_reached_sensor = false;
     send_log_start_tensioning();
+    force_waveform.start();
+    force_profile.start();
     block_sledge();
     cylinder_spanntaste.set(1);
+    input_capture.clear_edges(CAPTURE_SLEDGE_ENDPOSITION);
+    start_micros = micros();
     cycle_step_delay.set_unstarted();
   }
   void do_loop_stuff() {
@@ -1158,13 +1224,16 @@ class Tool_spannen : public Cycle_step {
     //   cylinder_spanntaste.set(0);
     //   set_loop_completed();
     // }
-    if (sensor_sledge_endposition.switched_high()) {
+    if (input_capture.switched_high(CAPTURE_SLEDGE_ENDPOSITION)) {
+      travel_time_sledge = get_travel_time(CAPTURE_SLEDGE_ENDPOSITION, start_micros);
       has_reached_sensor = true;
     }
 
     if (has_reached_sensor) {
       if (cycle_step_delay.delay_time_is_up(600)) {
         cylinder_spanntaste.set(0);
+        force_waveform.stop();
+        force_profile.stop();
         set_loop_completed();
       }
     }
@@ -1173,14 +1242,14 @@ class Tool_spannen : public Cycle_step {
 
 // MIT FÖRDERZYLINDER AKTIV SPANNEN UM BOGEN ZU VERMEIDEN
 class Foerderzylinder_stop : public Cycle_step {
-  String get_display_text() { return "FOERDER STOP"; }
+  const __FlashStringHelper *get_display_text() { return F("FOERDER STOP"); }
   void do_initial_stuff() { foerderzylinder_stop(); }
   void do_loop_stuff() { set_loop_completed(); }
 };
 
 // NACHKLEMME SCHLIESSEN
 class Nachklemme_zu : public Cycle_step {
-  String get_display_text() { return "NACHKLEMME ZU"; }
+  const __FlashStringHelper *get_display_text() { return F("NACHKLEMME ZU"); }
 
   void do_initial_stuff() {
     cylinder_hydr_nachklemme.set(1);
@@ -1199,7 +1268,7 @@ class Nachklemme_zu : public Cycle_step {
 
 // GERÄT CRIMPEN
 class Tool_crimp : public Cycle_step {
-  String get_display_text() { return "TOOL CRIMP"; }
+  const __FlashStringHelper *get_display_text() { return F("TOOL CRIMP"); }
 
   void do_initial_stuff() { send_log_start_crimping(); }
   void do_loop_stuff() {
@@ -1212,7 +1281,7 @@ class Tool_crimp : public Cycle_step {
 
 // WIPPENHEBEL BETÄTIGEN
 class Tool_wippe_auf : public Cycle_step {
-  String get_display_text() { return "TOOL WIPPENHEBEL"; }
+  const __FlashStringHelper *get_display_text() { return F("TOOL WIPPENHEBEL"); }
 
   void do_initial_stuff() {
     counter.count_one_up(shorttime_counter);
@@ -1227,7 +1296,7 @@ class Tool_wippe_auf : public Cycle_step {
 
 // PAUSE
 class Tool_pause : public Cycle_step {
-  String get_display_text() { return "PAUSE"; }
+  const __FlashStringHelper *get_display_text() { return F("PAUSE"); }
   unsigned long cycle_duration_millis;
   unsigned long cycle_time_elapsed;
   unsigned long cycle_time_remaining; // [ms]
@@ -1251,7 +1320,10 @@ class Tool_pause : public Cycle_step {
     static int previous_timeout_time = 0;
     int timeout_time = cycle_step_delay.get_remaining_delay_time() / 1000;
     if (timeout_time != previous_timeout_time) {
-      display_text_in_field("PAUSE " + String(timeout_time), "t0");
+      Small_string<12> pause_text;
+      pause_text.print(F("PAUSE "));
+      pause_text.print(timeout_time);
+      display_text_in_field(pause_text.c_str(), "t0", priority_cosmetic);
       previous_timeout_time = timeout_time;
     }
 
@@ -1282,45 +1354,163 @@ void get_electrocylinder_endpoints() {
   Serial.println("ZYLINDERINITIALISIERUNG ABGESCHLOSSEN");
 }
 
-void power_on_electrocylinder() {
-  Serial.println("ELEKTROZYLINDER POWER ON:");
-  // Festo specification ELGS-BS
-  // Turn on logic power >=50ms after load power:
-  delay(200);
-  digitalWrite(FOERDERZYLINDER_LOGIC_POWER_RELAY, HIGH);
+// RECOVERY TASKS (RESET, STOP, TIMEOUT) ****************************************
 
-  delay(8000); // wait until cylinder has initialized
-  digitalWrite(TRENNRELAIS_ZYLINDER_1, HIGH);
-  digitalWrite(TRENNRELAIS_ZYLINDER_2, HIGH);
-  // get_electrocylinder_endpoints();
+void abort_recovery_tasks() {
+  reset_task.abort();
+  stop_task.abort();
+  timeout_recovery_task.abort();
 }
 
-void power_off_electrocylinder() {
-  digitalWrite(FOERDERZYLINDER_MOVE_IN, LOW);
-  digitalWrite(FOERDERZYLINDER_MOVE_OUT, LOW);
+bool recovery_task_is_active() {
+  return reset_task.is_active() || stop_task.is_active() || timeout_recovery_task.is_active();
+}
 
-  // Disconnect electrocylinder analog outputs:
-  digitalWrite(TRENNRELAIS_ZYLINDER_1, LOW);
-  digitalWrite(TRENNRELAIS_ZYLINDER_2, LOW);
-  // Festo specification ELGS-BS
-  // Turn off logic power >= 100ms after analog outputs:
-  delay(200);
-  digitalWrite(FOERDERZYLINDER_LOGIC_POWER_RELAY, LOW);
+void run_reset_task() {
+  if (!reset_task.is_active()) {
+    return;
+  }
+  switch (reset_task.get_stage()) {
+  case 0:
+    reset_machine();
+    reset_task.switch_to_next_stage();
+    break;
+  case 1: // time for hydraulic cylinders to move back
+    if (reset_task.wait(1000)) {
+      cylinder_wippenhebel.set(1);
+      reset_task.switch_to_next_stage();
+    }
+    break;
+  case 2: // stroke wippenhebel
+    if (reset_task.wait(500)) {
+      cylinder_wippenhebel.set(0);
+      reset_task.switch_to_next_stage();
+    }
+    break;
+  case 3: // electrocylinder needs up to 8s after a power off
+    if (state_controller.electrocylinder_is_ready()) {
+      reset_task.set_completed();
+    }
+    break;
+  }
 }
 
-void stop_machine(String error_message) {
-  state_controller.set_machine_stop();
-  state_controller.set_step_mode();
-  reset_machine();
-  cylinder_hydr_pressure_valve.set(0);
-  stroke_wippenhebel();
-  cylinder_main_hauptluft.set(0);
-  power_off_electrocylinder();
-  show_info_field();
-  display_text_in_info_field(error_message);
+void run_stop_task() {
+  if (!stop_task.is_active()) {
+    return;
+  }
+  switch (stop_task.get_stage()) {
+  case 0:
+    state_controller.set_machine_stop();
+    state_controller.set_step_mode();
+    reset_machine();
+    stop_task.switch_to_next_stage();
+    break;
+  case 1: // time for hydraulic cylinders to move back
+    if (stop_task.wait(1000)) {
+      cylinder_hydr_pressure_valve.set(0);
+      cylinder_wippenhebel.set(1);
+      stop_task.switch_to_next_stage();
+    }
+    break;
+  case 2: // stroke wippenhebel
+    if (stop_task.wait(500)) {
+      cylinder_wippenhebel.set(0);
+      cylinder_main_hauptluft.set(0);
+      electrocylinder.power_off();
+      show_info_field(priority_safety);
+      display_text_in_info_field(stop_message, priority_safety);
+      stop_task.set_completed();
+    }
+    break;
+  }
 }
 
-void error_stop_machine(String error_message) {
+void run_timeout_recovery_task() {
+  if (!timeout_recovery_task.is_active()) {
+    return;
+  }
+  switch (timeout_recovery_task.get_stage()) {
+  case 0:
+    state_controller.set_machine_stop();
+    show_info_field(priority_safety);
+    display_text_in_info_field("STOPPED ...", priority_safety);
+    timeout_recovery_task.switch_to_next_stage();
+    break;
+  case 1:
+    if (timeout_recovery_task.wait(2000)) {
+      machine_stopped_error_timeout.reset_time();
+      bandsensor_timeout.reset_time();
+      bandbogen_timeout.reset_time();
+
+      if (reset_count == 0) {
+        show_info_field(priority_safety);
+        display_text_in_info_field("RESET 1", priority_safety);
+        timeout_recovery_task.switch_to_next_stage();
+      }
+
+      else if (reset_count == 1) {
+        show_info_field(priority_safety);
+        display_text_in_info_field("RESET 2", priority_safety);
+        timeout_recovery_task.switch_to_next_stage();
+      }
+
+      else if (reset_count == 2) {
+        // Stop and show error:
+        timeout_recovery_task.set_completed();
+        error_stop_machine("TIMEOUT ERROR");
+      }
+    }
+    break;
+  case 2:
+    if (timeout_recovery_task.wait(2000)) {
+      // Reset and restart:
+      reset_count++;
+      state_controller.set_reset_mode(1);
+      state_controller.set_run_after_reset(1);
+      timeout_recovery_task.set_completed();
+    }
+    break;
+  }
+}
+
+void run_recovery_tasks() {
+  run_stop_task();
+  run_timeout_recovery_task();
+
+  // START RESET IF RESET IS ACTIVATED:
+  if (state_controller.reset_mode_is_active() && !reset_task.is_active()) {
+    abort_recovery_tasks();
+    reset_task.start();
+  }
+  run_reset_task();
+
+  if (reset_task.is_completed()) {
+    state_controller.set_reset_mode(0);
+
+    if (state_controller.run_after_reset_is_active()) {
+      state_controller.set_auto_mode();
+      state_controller.set_machine_running();
+    } else {
+      state_controller.set_step_mode();
+    }
+  }
+
+  // KEEP MACHINE STOPPED UNTIL RECOVERY HAS FINISHED:
+  if (recovery_task_is_active() || electrocylinder.is_powering_on()) {
+    state_controller.set_machine_stop();
+  }
+}
+
+void stop_machine(const char *error_message) {
+  abort_recovery_tasks();
+  state_controller.set_reset_mode(0);
+  stop_message = error_message;
+  stop_task.start();
+  run_stop_task(); // first stage stops the machine immediately
+}
+
+void error_stop_machine(const char *error_message) {
   stop_machine(error_message);
   send_email_machine_stopped();
   state_controller.set_error_mode(true);
@@ -1329,11 +1519,17 @@ void error_stop_machine(String error_message) {
 void monitor_emergency_signal() {
 
   static bool emergency_stop_active = false;
+  static bool restart_pending = false;
 
-  // (RE-)START SYSTEM
   if (emergency_stop_signal.switched_low()) {
     emergency_stop_active = false;
-    power_on_electrocylinder();
+    restart_pending = true;
+  }
+
+  // (RE-)START SYSTEM (AFTER THE STOP SEQUENCE HAS FINISHED)
+  if (restart_pending && !stop_task.is_active()) {
+    restart_pending = false;
+    electrocylinder.power_on();
     hydraulic_timeout.reset_time();
     cylinder_hydr_pressure_valve.set(1);
     cylinder_main_hauptluft.set(1);
@@ -1342,6 +1538,7 @@ void monitor_emergency_signal() {
   // STOP SYSTEM (LOOP RUNS ONLY ONCE)
   if (emergency_stop_signal.switched_high()) {
     emergency_stop_active = true;
+    restart_pending = false;
     stop_machine("NOT AUS AKTIV");
   }
 
@@ -1367,37 +1564,8 @@ void monitor_error_timeouts() {
 
   // TIMEOUT IF STUCK IN A CYCLE:
   else if (machine_stopped_error_timeout.has_timed_out()) {
-    show_info_field();
-    display_text_in_info_field("STOPPED ...");
-    delay(2000);
-    machine_stopped_error_timeout.reset_time();
-    bandsensor_timeout.reset_time();
-    bandbogen_timeout.reset_time();
-
-    if (reset_count == 0) {
-      // Reset and restart:
-      show_info_field();
-      display_text_in_info_field("RESET 1");
-      delay(2000);
-      reset_count++;
-      state_controller.set_reset_mode(1);
-      state_controller.set_run_after_reset(1);
-    }
-
-    else if (reset_count == 1) {
-      // Reset and restart:
-      show_info_field();
-      display_text_in_info_field("RESET 2");
-      delay(2000);
-      reset_count++;
-      state_controller.set_reset_mode(1);
-      state_controller.set_run_after_reset(1);
-    }
-
-    else if (reset_count == 2) {
-      // Stop and show error:
-      error_stop_machine("TIMEOUT ERROR");
-    }
+    timeout_recovery_task.start();
+    run_timeout_recovery_task(); // first stage stops the machine immediately
   }
 
 
@@ -1409,6 +1577,74 @@ void monitor_temperature_error() {
   }
 }
 
+// CYCLE STEP OBJECTS AND SEQUENCE *********************************************
+// All steps are allocated statically, the sequence table is kept in flash.
+// A step that appears more than once in the sequence needs one object per entry.
+
+Luft_ablassen step_luft_ablassen;
+Vorklemme_auf step_vorklemme_auf;
+Schlitten_zurueck step_schlitten_zurueck;
+Nachklemme_auf step_nachklemme_auf;
+Auswerfen step_auswerfen;
+Foerderklemme_zu step_foerderklemme_zu_1;
+Foerdern step_foerdern;
+Vorklemme_zu step_vorklemme_zu;
+Schneiden step_schneiden;
+Foerdereinheit_auf step_foerdereinheit_auf_1;
+Foerderzylinder_zurueck step_foerderzylinder_zurueck_1;
+Auswerfer_zurueck step_auswerfer_zurueck;
+Tool_wippe_zu step_tool_wippe_zu;
+Foerderklemme_zu step_foerderklemme_zu_2;
+Aktiv_spannen step_aktiv_spannen;
+Tool_spannen step_tool_spannen;
+Foerderzylinder_stop step_foerderzylinder_stop;
+Nachklemme_zu step_nachklemme_zu;
+Foerdereinheit_auf step_foerdereinheit_auf_2;
+Foerderzylinder_zurueck step_foerderzylinder_zurueck_2;
+Tool_crimp step_tool_crimp;
+Tool_wippe_auf step_tool_wippe_auf;
+Tool_pause step_tool_pause;
+
+struct Cycle_step_entry {
+  Cycle_step *step;
+  bool is_parallel_to_previous;
+};
+
+// SEQUENCE OF THE TABLE = CYCLE SEQUENCE !
+// PARALLEL STEPS RUN TOGETHER WITH THE PREVIOUS STEP(S),
+// THEY MUST NOT SHARE HARDWARE OR THE CYCLE STEP DELAY !
+const Cycle_step_entry main_cycle_sequence[] PROGMEM = {
+    {&step_luft_ablassen, false}, //
+    {&step_vorklemme_auf, false}, //
+    {&step_schlitten_zurueck, false}, //
+    {&step_nachklemme_auf, false}, //
+    {&step_auswerfen, true}, //
+    {&step_foerderklemme_zu_1, true}, //
+    {&step_foerdern, false}, //
+    {&step_vorklemme_zu, false}, //
+    {&step_schneiden, false}, //
+    {&step_foerdereinheit_auf_1, false}, //
+    {&step_foerderzylinder_zurueck_1, false}, //
+    {&step_auswerfer_zurueck, false}, //
+    // {&step_messer_auf, false}, //
+    {&step_tool_wippe_zu, false}, //
+    {&step_foerderklemme_zu_2, false}, //
+    {&step_aktiv_spannen, false}, //
+    {&step_tool_spannen, false}, //
+    {&step_foerderzylinder_stop, false}, //
+    {&step_nachklemme_zu, false}, //
+    {&step_foerdereinheit_auf_2, false}, //
+    {&step_foerderzylinder_zurueck_2, false}, //
+    {&step_tool_crimp, false}, //
+    {&step_tool_wippe_auf, false}, //
+    {&step_tool_pause, false} //
+};
+const int no_of_main_cycle_steps = sizeof(main_cycle_sequence) / sizeof(main_cycle_sequence[0]);
+
+Cycle_step *get_cycle_step(int step) {
+  return (Cycle_step *)pgm_read_ptr(&main_cycle_sequence[step].step);
+}
+
 // MAIN SETUP ******************************************************************
 
 void setup() {
@@ -1419,42 +1655,30 @@ void setup() {
   pinMode(FOERDERZYLINDER_LOGIC_POWER_RELAY, OUTPUT);
   pinMode(FOERDERZYLINDER_MOVE_IN, OUTPUT);
   pinMode(FOERDERZYLINDER_MOVE_OUT, OUTPUT);
+  input_capture.begin();
+  analog_acquisition.record_channel(ADC_PRESSURE);
+  analog_acquisition.begin();
+#ifdef TRACE_INPUTS
+  input_trace.set_analog_reader(read_acquired_analog_input);
+#endif
 
-  //------------------------------------------------
-  // PUSH THE CYCLE STEPS INTO THE VECTOR CONTAINER:
-  // PUSH SEQUENCE = CYCLE SEQUENCE !
-  main_cycle_steps.push_back(new Luft_ablassen);
-  main_cycle_steps.push_back(new Vorklemme_auf);
-  main_cycle_steps.push_back(new Schlitten_zurueck);
-  main_cycle_steps.push_back(new Nachklemme_auf);
-  main_cycle_steps.push_back(new Auswerfen);
-  main_cycle_steps.push_back(new Foerderklemme_zu);
-  main_cycle_steps.push_back(new Foerdern);
-  main_cycle_steps.push_back(new Vorklemme_zu);
-  main_cycle_steps.push_back(new Schneiden);
-  main_cycle_steps.push_back(new Foerdereinheit_auf);
-  main_cycle_steps.push_back(new Foerderzylinder_zurueck);
-  main_cycle_steps.push_back(new Auswerfer_zurueck);
-  // main_cycle_steps.push_back(new Messer_auf);
-  main_cycle_steps.push_back(new Tool_wippe_zu);
-  main_cycle_steps.push_back(new Foerderklemme_zu);
-  main_cycle_steps.push_back(new Aktiv_spannen);
-  main_cycle_steps.push_back(new Tool_spannen);
-  main_cycle_steps.push_back(new Foerderzylinder_stop);
-  main_cycle_steps.push_back(new Nachklemme_zu);
-  main_cycle_steps.push_back(new Foerdereinheit_auf);
-  main_cycle_steps.push_back(new Foerderzylinder_zurueck);
-  main_cycle_steps.push_back(new Tool_crimp);
-  main_cycle_steps.push_back(new Tool_wippe_auf);
-  main_cycle_steps.push_back(new Tool_pause);
   //------------------------------------------------
   // CONFIGURE THE STATE CONTROLLER:
-  int no_of_main_cycle_steps = main_cycle_steps.size();
   state_controller.set_no_of_steps(no_of_main_cycle_steps);
+  for (int i = 0; i < no_of_main_cycle_steps; i++) {
+    if (pgm_read_byte(&main_cycle_sequence[i].is_parallel_to_previous)) {
+      state_controller.set_step_parallel_to_previous(i);
+    }
+  }
+  step_timer.set_no_of_steps(no_of_main_cycle_steps);
   //------------------------------------------------
   // SETUP COUNTER:
   counter.setup(0, 1023, counter_no_of_values);
   //------------------------------------------------
+  // LOAD SENSOR CALIBRATIONS (LINEAR CONVERSION IF NONE STORED):
+  force_conversion.load_calibration();
+  temperature_conversion.load_calibration();
+  //------------------------------------------------
   Serial.begin(115200);
   Serial1.begin(115200); // used to log to raspberry log merger via USB-Serial-Converter @ TX1/RX1
   state_controller.set_step_mode();
@@ -1465,7 +1689,7 @@ void setup() {
   reset_flag_of_current_step();
 
   if (!emergency_stop_signal.get_raw_button_state()) { // emergency stop not activated
-    power_on_electrocylinder();
+    electrocylinder.power_on(); // runs in the background, display stays live
     cylinder_hydr_pressure_valve.set(1);
     cylinder_main_hauptluft.set(1);
   }
@@ -1478,10 +1702,29 @@ void setup() {
 
 void run_step_or_auto_mode() {
 
-  // IF STEP IS COMPLETED SWITCH TO NEXT STEP:
-  if (main_cycle_steps[state_controller.get_current_step()]->is_completed()) {
+  // IF ALL STEPS OF THE GROUP ARE COMPLETED SWITCH TO NEXT STEP (GROUP):
+  int first_step = state_controller.get_current_step();
+  int last_step = state_controller.get_last_step_of_current_group();
+  bool group_is_completed = true;
+
+  for (int i = first_step; i <= last_step; i++) {
+    unsigned long step_bit = 1UL << (i - first_step);
+    if (!(completed_steps_of_group & step_bit) && get_cycle_step(i)->is_completed()) {
+      completed_steps_of_group |= step_bit;
+      step_timer.set_step_completed(i);
+    }
+    if (!(completed_steps_of_group & step_bit)) {
+      group_is_completed = false;
+    }
+  }
+
+  if (group_is_completed) {
+    step_timer.stop_timing();
     state_controller.switch_to_next_step();
     reset_flag_of_current_step();
+    if (state_controller.get_current_step() == 0) {
+      close_cycle_records(); // Tool_pause has completed the cycle
+    }
   }
 
   // IN STEP MODE, THE RIG STOPS AFTER EVERY COMPLETED STEP:
@@ -1497,9 +1740,17 @@ void run_step_or_auto_mode() {
     }
   }
 
-  // IF MACHINE STATE IS "RUNNING", RUN CURRENT STEP:
+  // IF MACHINE STATE IS "RUNNING", RUN ALL UNCOMPLETED STEPS OF THE GROUP:
   if (state_controller.machine_is_running()) {
-    main_cycle_steps[state_controller.get_current_step()]->do_stuff();
+    first_step = state_controller.get_current_step();
+    last_step = state_controller.get_last_step_of_current_group();
+    step_timer.set_group_running(first_step);
+
+    for (int i = first_step; i <= last_step; i++) {
+      if (!(completed_steps_of_group & (1UL << (i - first_step)))) {
+        get_cycle_step(i)->do_stuff();
+      }
+    }
   }
 
   // MEASURE AND DISPLAY PRESSURE
@@ -1508,13 +1759,96 @@ void run_step_or_auto_mode() {
   }
 }
 
+#ifdef PRINT_DEBUG_INFO
+long measure_runtime() {
+  static long previous_micros = micros();
+  long time_elapsed = micros() - previous_micros;
+  previous_micros = micros();
+  return time_elapsed;
+}
+
+// One line per scan, a line is only sent when it fits into the TX buffer:
+void send_debug_info() {
+  const byte no_of_debug_lines = end_of_priority_enum + 4;
+  static byte next_line = no_of_debug_lines;
+  static long max_runtime = 0;
+  static long reported_max_runtime = 0;
+
+  max_runtime = max(max_runtime, measure_runtime());
+  if (next_line >= no_of_debug_lines) {
+    if (!print_interval_timeout.has_timed_out()) {
+      return;
+    }
+    print_interval_timeout.reset_time();
+    reported_max_runtime = max_runtime;
+    max_runtime = 0;
+    next_line = 0;
+  }
+
+  Small_string<64> line;
+  byte priority = next_line - 1; // of the display lines
+  if (next_line == 0) {
+    line.print("MAX SCAN TIME [us]: ");
+    line.print(reported_max_runtime);
+  } else if (next_line <= end_of_priority_enum) {
+    line.print("DISPLAY DROPPED/MAX WAIT [ms]: ");
+    line.print(display_priority_names[priority]);
+    line.print(" ");
+    line.print(nextion_queue.get_no_of_dropped_commands(priority));
+    line.print("/");
+    line.print(nextion_queue.get_max_wait_time(priority));
+  } else if (next_line == end_of_priority_enum + 1) {
+    line.print("HEAP ALLOCATIONS: ");
+    line.print(get_heap_allocation_count());
+  } else if (next_line == end_of_priority_enum + 2) {
+    line.print("FORCE WAVEFORM POINTS SENT/SKIPPED: ");
+    line.print(force_waveform.get_no_of_points_sent());
+    line.print("/");
+    line.print(force_waveform.get_no_of_points_skipped());
+  } else {
+    line.print("MAX TOUCH LATENCY [us]: ");
+    line.print(touch_dispatcher.get_max_latency());
+  }
+  line.print("\r\n");
+  if (Serial.availableForWrite() < line.length()) {
+    return;
+  }
+  Serial.print(line.c_str());
+
+  if (next_line == end_of_priority_enum) {
+    nextion_queue.clear_max_wait_times();
+  }
+  if (next_line == no_of_debug_lines - 1) {
+    touch_dispatcher.clear_max_latency();
+  }
+  next_line++;
+}
+#endif
+
 void loop() {
 
+  scan_profiler.start_scan();
+
+  // READ SENSOR EDGES CAPTURED SINCE THE LAST SCAN AND THE LATEST ANALOG VALUES:
+  input_capture.update();
+  analog_acquisition.update();
+  record_force_profile();
+
+#ifdef TRACE_INPUTS
+  input_trace.send_trace(Serial1);
+#endif
+
   // MONITOR EMERGENCY SIGNAL:
   monitor_emergency_signal();
 
+  // POWER ELECTROCYLINDER ON OR OFF:
+  electrocylinder.update();
+  state_controller.set_electrocylinder_ready(electrocylinder.is_ready());
+  scan_profiler.measure_section(profile_emergency);
+
   // MEASURE AND DISPLAY MOTOR TEMPERATURE
   display_temperature();
+  scan_profiler.measure_section(profile_temperature);
 
   // CONTROL COOLING AIR
   cylinder_kuehlluft.set(state_controller.is_in_auto_mode());
@@ -1531,28 +1865,21 @@ void loop() {
     monitor_error_timeouts();
     monitor_temperature_error();
   }
+  scan_profiler.measure_section(profile_error_monitor);
 
   // UPDATE DISPLAY:
   nextion_display_loop();
+  scan_profiler.measure_section(profile_display);
 
   // RUN STEP OR AUTO MODE:
   if (state_controller.is_in_step_mode() || state_controller.is_in_auto_mode()) {
     run_step_or_auto_mode();
   }
+  scan_profiler.measure_section(profile_steps);
 
-  // RUN RESET IF RESET IS ACTIVATED:
-  if (state_controller.reset_mode_is_active()) {
-    reset_machine();
-    stroke_wippenhebel();
-    state_controller.set_reset_mode(0);
-
-    if (state_controller.run_after_reset_is_active()) {
-      state_controller.set_auto_mode();
-      state_controller.set_machine_running();
-    } else {
-      state_controller.set_step_mode();
-    }
-  }
+  // RUN RESET, STOP AND TIMEOUT SEQUENCES WITHOUT BLOCKING THE LOOP:
+  run_recovery_tasks();
+  scan_profiler.measure_section(profile_reset);
 
   // CHECK IF STRAP AVAILABLE:
   if (bandsensor_zufuhr_unten.get_raw_button_state() && bandsensor_zufuhr_oben.get_raw_button_state()) {
@@ -1563,13 +1890,12 @@ void loop() {
   if (bandbogensensor.get_raw_button_state()) {
     bandbogen_timeout.reset_time();
   }
+  scan_profiler.measure_section(profile_sensors);
+
+#ifdef PRINT_DEBUG_INFO
+  send_debug_info();
+#endif
 
-  // DISPLAY DEBUG INFOMATION:
-  //unsigned long runtime = measure_runtime();
-  if (print_interval_timeout.has_timed_out()) {
-    //Serial.println(runtime);
-    print_interval_timeout.reset_time();
-  }
   // POWER OFF HYDRAULIC AFTER A WHILE OF INACTIVITY
   if (hydraulic_timeout.has_timed_out()) {
     cylinder_hydr_power_supply.set(0);
@@ -1579,6 +1905,11 @@ void loop() {
   if (!hydraulic_safety_sensor_1.get_raw_button_state() || !hydraulic_safety_sensor_2.get_raw_button_state()) {
     cylinder_hydr_power_supply.set(0);
   }
+
+  // SEND SCAN PROFILE AND CYCLE RECORDS:
+  scan_profiler.measure_scan(profile_scan);
+  scan_profiler.send_report(Serial1);
+  send_log_cycle_records();
 }
 
 // END OF PROGRAM **************************************************************
\ No newline at end of file
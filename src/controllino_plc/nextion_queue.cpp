@@ -0,0 +1,219 @@
+/*******************************************************************************
+ * nextion_queue.cpp ***********************************************************
+ *******************************************************************************/
+
+#include "nextion_queue.h"
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Nextion_queue::Nextion_queue() {
+  _no_of_commands = 0;
+  _is_sending = false;
+  _bytes_sent_of_sending_command = 0;
+  _bytes_per_second = 0;
+  _budget = 0;
+  _budget_update_millis = 0;
+  for (byte i = 0; i < end_of_priority_enum; i++) {
+    _no_of_queued_commands[i] = 0;
+    _no_of_coalesced_commands[i] = 0;
+    _no_of_dropped_commands[i] = 0;
+    _no_of_sent_commands[i] = 0;
+    _max_wait_time[i] = 0;
+  }
+  clear_new_command();
+}
+
+// ADD COMMANDS ----------------------------------------------------------------
+size_t Nextion_queue::write(uint8_t c) {
+  if (_new_command.length >= NEXTION_QUEUE_COMMAND_SIZE) {
+    _new_command_is_too_long = true;
+    return 0;
+  }
+  _new_command.text[_new_command.length++] = c;
+  return 1;
+}
+
+void Nextion_queue::end_command(byte priority, bool may_coalesce) {
+  priority = min(priority, byte(end_of_priority_enum - 1));
+  if (_new_command_is_too_long) {
+    _no_of_dropped_commands[priority]++;
+    clear_new_command();
+    return;
+  }
+  if (_new_command.length == 0) {
+    return;
+  }
+  _new_command.may_coalesce = may_coalesce;
+  _new_command.key_length = get_key_length(_new_command);
+  _new_command.priority = priority;
+  _new_command.queued_millis = millis();
+
+  if (coalesce_new_command()) {
+    _no_of_coalesced_commands[priority]++;
+  } else if (make_room_for_new_command()) {
+    _commands[_no_of_commands++] = _new_command;
+    _no_of_queued_commands[priority]++;
+  } else {
+    _no_of_dropped_commands[priority]++;
+  }
+  clear_new_command();
+}
+
+byte Nextion_queue::get_key_length(const Command &command) {
+  for (byte i = 0; i < command.length; i++) {
+    if (command.text[i] == '=' || command.text[i] == ',') {
+      return i + 1;
+    }
+  }
+  return 0; // no key, never coalesced
+}
+
+// Replaces the first pending command with the same key and the same or a lower
+// priority, further ones are removed. The command being sent is not pending.
+bool Nextion_queue::coalesce_new_command() {
+  if (!_new_command.may_coalesce || !_new_command.key_length) {
+    return false;
+  }
+  bool has_replaced = false;
+  byte i = 0;
+  while (i < _no_of_commands) {
+    Command &command = _commands[i];
+    if (command.may_coalesce && command.priority >= _new_command.priority &&
+        command.key_length == _new_command.key_length &&
+        memcmp(command.text, _new_command.text, command.key_length) == 0) {
+      if (!has_replaced) {
+        _new_command.queued_millis = command.queued_millis; // waits since the replaced command
+        command = _new_command;
+        has_replaced = true;
+      } else {
+        remove_command(i);
+        continue;
+      }
+    }
+    i++;
+  }
+  return has_replaced;
+}
+
+// Drops the oldest command of the lowest priority below the new command:
+bool Nextion_queue::make_room_for_new_command() {
+  if (_no_of_commands < NEXTION_QUEUE_MAX_COMMANDS) {
+    return true;
+  }
+  byte lowest = 0;
+  for (byte i = 1; i < _no_of_commands; i++) {
+    if (_commands[i].priority > _commands[lowest].priority) {
+      lowest = i;
+    }
+  }
+  if (_commands[lowest].priority <= _new_command.priority) {
+    return false;
+  }
+  _no_of_dropped_commands[_commands[lowest].priority]++;
+  remove_command(lowest);
+  return true;
+}
+
+void Nextion_queue::remove_command(byte index) {
+  _no_of_commands--;
+  for (byte i = index; i < _no_of_commands; i++) {
+    _commands[i] = _commands[i + 1];
+  }
+}
+
+void Nextion_queue::clear_new_command() {
+  _new_command.length = 0;
+  _new_command_is_too_long = false;
+}
+
+// SEND COMMANDS ---------------------------------------------------------------
+void Nextion_queue::send_commands(HardwareSerial &port) {
+  update_budget();
+  int free_bytes = port.availableForWrite();
+  while (free_bytes > 0) {
+    if (!_is_sending && !start_next_command()) {
+      return;
+    }
+    byte total_length = _sending_command.length + 3; // terminator 0xff 0xff 0xff
+    while (free_bytes > 0 && _bytes_sent_of_sending_command < total_length) {
+      byte i = _bytes_sent_of_sending_command++;
+      port.write(i < _sending_command.length ? uint8_t(_sending_command.text[i]) : uint8_t(0xff));
+      free_bytes--;
+    }
+    if (_bytes_sent_of_sending_command == total_length) {
+      _is_sending = false;
+      _bytes_sent_of_sending_command = 0;
+    }
+  }
+}
+
+// Takes the oldest command of the highest priority out of the queue:
+bool Nextion_queue::start_next_command() {
+  if (!_no_of_commands) {
+    return false;
+  }
+  byte next = 0;
+  for (byte i = 1; i < _no_of_commands; i++) {
+    if (_commands[i].priority < _commands[next].priority) {
+      next = i;
+    }
+  }
+  const Command &command = _commands[next];
+  long cost = long(command.length + 3) * 1000;
+  if (_bytes_per_second) {
+    if (command.priority != priority_safety && _budget < cost) {
+      return false; // lower priorities wait as well
+    }
+    _budget -= cost;
+  }
+  unsigned long wait_time = millis() - command.queued_millis;
+  if (wait_time > _max_wait_time[command.priority]) {
+    _max_wait_time[command.priority] = wait_time;
+  }
+  _no_of_sent_commands[command.priority]++;
+  _sending_command = command;
+  remove_command(next);
+  _is_sending = true;
+  return true;
+}
+
+// At most a quarter of a second (or one long command) is saved up:
+void Nextion_queue::update_budget() {
+  unsigned long now = millis();
+  unsigned long elapsed_time = min(now - _budget_update_millis, 1000UL);
+  _budget_update_millis = now;
+  _budget += long(elapsed_time) * _bytes_per_second;
+  long max_budget = max(long(_bytes_per_second) * 250, long(NEXTION_QUEUE_COMMAND_SIZE + 3) * 1000);
+  if (_budget > max_budget) {
+    _budget = max_budget;
+  }
+}
+
+// SETTER ----------------------------------------------------------------------
+void Nextion_queue::set_bytes_per_second(unsigned int bytes_per_second) {
+  _bytes_per_second = bytes_per_second;
+  _budget = 0;
+  _budget_update_millis = millis();
+}
+
+// GETTER ----------------------------------------------------------------------
+bool Nextion_queue::is_empty() { return _no_of_commands == 0 && !_is_sending; }
+
+unsigned int Nextion_queue::get_bytes_per_second() { return _bytes_per_second; }
+
+unsigned long Nextion_queue::get_no_of_queued_commands(byte priority) { return _no_of_queued_commands[priority]; }
+
+unsigned long Nextion_queue::get_no_of_coalesced_commands(byte priority) {
+  return _no_of_coalesced_commands[priority];
+}
+
+unsigned long Nextion_queue::get_no_of_dropped_commands(byte priority) { return _no_of_dropped_commands[priority]; }
+
+unsigned long Nextion_queue::get_no_of_sent_commands(byte priority) { return _no_of_sent_commands[priority]; }
+
+unsigned long Nextion_queue::get_max_wait_time(byte priority) { return _max_wait_time[priority]; }
+
+void Nextion_queue::clear_max_wait_times() {
+  for (byte i = 0; i < end_of_priority_enum; i++) {
+    _max_wait_time[i] = 0;
+  }
+}
@@ -0,0 +1,108 @@
+/* *****************************************************************************
+ * nextion_queue.h *************************************************************
+ * *****************************************************************************
+ * Non blocking command queue for the Nextion display.
+ *
+ * A command is printed into the queue like into a serial port and closed with
+ * end_command(), the 0xff 0xff 0xff terminator is added when it is sent.
+ * send_commands() writes only as many bytes as fit into the TX buffer,
+ * a command can be spread over several scans.
+ *
+ * Coalescing: a new command replaces a pending command with the same key,
+ * the key is the command up to the first '=' or ',' (e.g. "t0.txt=" or
+ * "vis t4,"). Commands like switch toggles are added without coalescing.
+ * A command never replaces a pending command of a higher priority.
+ *
+ * Priorities: the oldest command of the highest priority is sent first.
+ * A budget of bytes per second limits the display traffic, commands wait
+ * until the budget allows to send them. Safety commands are sent without
+ * waiting for the budget (but use it up), lower priorities are deferred.
+ * If the queue is full, the oldest command of the lowest priority below the
+ * new command is dropped to make room, otherwise the new command is dropped.
+ * Queued, coalesced, dropped and sent commands and the longest wait are
+ * counted per priority.
+ * *****************************************************************************
+ */
+
+#ifndef NEXTIONQUEUE_H
+#define NEXTIONQUEUE_H
+
+#include <Arduino.h>
+
+#ifndef NEXTION_QUEUE_MAX_COMMANDS
+#define NEXTION_QUEUE_MAX_COMMANDS 16
+#endif
+#ifndef NEXTION_QUEUE_COMMAND_SIZE
+#define NEXTION_QUEUE_COMMAND_SIZE 36
+#endif
+
+enum Display_priority {
+  priority_safety, //   errors and stop messages
+  priority_mode, //     machine mode and cycle step
+  priority_process, //  process values like the force
+  priority_cosmetic, // temperature, counters, pause countdown
+  end_of_priority_enum // keep this entry
+};
+
+class Nextion_queue : public Print {
+
+public:
+  // FUNCTIONS:
+  Nextion_queue();
+
+  size_t write(uint8_t c);
+  using Print::write;
+  void end_command(byte priority = priority_process, bool may_coalesce = true);
+  void send_commands(HardwareSerial &port);
+
+  // SETTER:
+  void set_bytes_per_second(unsigned int bytes_per_second); // 0 = no budget
+
+  // GETTER:
+  bool is_empty();
+  unsigned int get_bytes_per_second();
+  unsigned long get_no_of_queued_commands(byte priority);
+  unsigned long get_no_of_coalesced_commands(byte priority);
+  unsigned long get_no_of_dropped_commands(byte priority);
+  unsigned long get_no_of_sent_commands(byte priority);
+  unsigned long get_max_wait_time(byte priority); // [ms] from queued to sending
+  void clear_max_wait_times();
+
+private:
+  // VARIABLES:
+  struct Command {
+    char text[NEXTION_QUEUE_COMMAND_SIZE];
+    byte length;
+    byte key_length;
+    bool may_coalesce;
+    byte priority;
+    unsigned long queued_millis;
+  };
+  Command _commands[NEXTION_QUEUE_MAX_COMMANDS]; // pending commands, oldest first
+  Command _new_command;
+  Command _sending_command;
+  bool _new_command_is_too_long;
+  bool _is_sending;
+  byte _no_of_commands;
+  byte _bytes_sent_of_sending_command;
+
+  unsigned int _bytes_per_second;
+  long _budget; // [bytes * 1000], refilled by bytes_per_second every ms
+  unsigned long _budget_update_millis;
+
+  unsigned long _no_of_queued_commands[end_of_priority_enum];
+  unsigned long _no_of_coalesced_commands[end_of_priority_enum];
+  unsigned long _no_of_dropped_commands[end_of_priority_enum];
+  unsigned long _no_of_sent_commands[end_of_priority_enum];
+  unsigned long _max_wait_time[end_of_priority_enum];
+
+  // FUNCTIONS:
+  byte get_key_length(const Command &command);
+  bool coalesce_new_command();
+  bool make_room_for_new_command();
+  void remove_command(byte index);
+  bool start_next_command();
+  void update_budget();
+  void clear_new_command();
+};
+#endif
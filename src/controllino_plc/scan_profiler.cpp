@@ -0,0 +1,117 @@
+/*******************************************************************************
+ * scan_profiler.cpp ***********************************************************
+ *******************************************************************************/
+
+#include "scan_profiler.h"
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Scan_profiler::Scan_profiler(const char *const *section_names, byte number_of_sections,
+                             unsigned long report_interval) {
+  _section_names = section_names;
+  _number_of_sections = min(number_of_sections, (byte)SCAN_PROFILER_MAX_SECTIONS);
+  _next_section_to_report = _number_of_sections; // no report in progress
+  _report_timeout.set_time(report_interval);
+  for (byte i = 0; i < _number_of_sections; i++) {
+    clear_record(i);
+  }
+}
+
+// MEASUREMENT -----------------------------------------------------------------
+void Scan_profiler::start_scan() {
+  _scan_start_micros = micros();
+  _section_start_micros = _scan_start_micros;
+}
+
+// Measures the time since the previous section has been measured:
+void Scan_profiler::measure_section(byte section) {
+  unsigned long now = micros();
+  add_measurement(section, now - _section_start_micros);
+  _section_start_micros = now;
+}
+
+// Measures the time since start_scan():
+void Scan_profiler::measure_scan(byte section) {
+  unsigned long now = micros();
+  add_measurement(section, now - _scan_start_micros);
+  _section_start_micros = now;
+}
+
+void Scan_profiler::add_measurement(byte section, unsigned long runtime) {
+  if (section >= _number_of_sections) {
+    return;
+  }
+  Section_record &record = _records[section];
+  if (runtime < record.min_micros) {
+    record.min_micros = runtime;
+  }
+  if (runtime > record.max_micros) {
+    record.max_micros = runtime;
+  }
+  record.sum_micros += runtime;
+  // Saturate instead of overflow:
+  if (record.count < 0xFFFF) {
+    record.count++;
+  }
+  byte bin = get_bin(runtime);
+  if (record.bins[bin] < 0xFFFF) {
+    record.bins[bin]++;
+  }
+}
+
+byte Scan_profiler::get_bin(unsigned long runtime) {
+  byte bin = 0;
+  while (runtime > 1 && bin < SCAN_PROFILER_NO_OF_BINS - 1) {
+    runtime >>= 1;
+    bin++;
+  }
+  return bin;
+}
+
+void Scan_profiler::clear_record(byte section) {
+  Section_record &record = _records[section];
+  record.min_micros = 0xFFFFFFFF;
+  record.max_micros = 0;
+  record.sum_micros = 0;
+  record.count = 0;
+  for (byte i = 0; i < SCAN_PROFILER_NO_OF_BINS; i++) {
+    record.bins[i] = 0;
+  }
+}
+
+// REPORT ----------------------------------------------------------------------
+// Sends one section per call to keep the serial buffer from blocking the loop.
+void Scan_profiler::send_report(Print &port) {
+  if (_next_section_to_report >= _number_of_sections) {
+    if (!_report_timeout.has_timed_out()) {
+      return;
+    }
+    _report_timeout.reset_time();
+    _next_section_to_report = 0;
+  }
+
+  byte section = _next_section_to_report;
+  Section_record &record = _records[section];
+  unsigned long mean = record.count ? record.sum_micros / record.count : 0;
+
+  port.print("LOG;SCAN_PROFILE;");
+  port.print(_section_names[section]);
+  port.print(";");
+  port.print(record.count);
+  port.print(";");
+  port.print(record.count ? record.min_micros : 0);
+  port.print(";");
+  port.print(mean);
+  port.print(";");
+  port.print(record.max_micros);
+  port.print(";");
+  for (byte i = 0; i < SCAN_PROFILER_NO_OF_BINS; i++) {
+    if (i > 0) {
+      port.print(",");
+    }
+    port.print(record.bins[i]);
+  }
+  port.println(";");
+
+  clear_record(section);
+  _next_section_to_report++;
+}
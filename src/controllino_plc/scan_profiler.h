@@ -0,0 +1,60 @@
+/* *****************************************************************************
+ * scan_profiler.h *************************************************************
+ * *****************************************************************************
+ * Measures the runtime of the sections of the main loop in microseconds.
+ * Every section keeps min/max/mean and a log2 histogram in a fixed RAM budget.
+ *
+ * Bin n of the histogram counts runtimes from 2^n to 2^(n+1)-1 micros,
+ * the last bin counts everything above.
+ *
+ * Every report interval one line per section is sent, one section per scan:
+ * LOG;SCAN_PROFILE;<NAME>;<count>;<min>;<mean>;<max>;<bin0>,<bin1>,...;
+ * The values of a section are cleared after they have been sent.
+ * *****************************************************************************
+ */
+
+#ifndef SCANPROFILER_H
+#define SCANPROFILER_H
+
+#include <Arduino.h>
+#include <Insomnia.h> // https://github.com/chischte/insomnia-delay-library
+
+#ifndef SCAN_PROFILER_MAX_SECTIONS
+#define SCAN_PROFILER_MAX_SECTIONS 10
+#endif
+#define SCAN_PROFILER_NO_OF_BINS 16
+
+class Scan_profiler {
+
+public:
+  // FUNCTIONS:
+  Scan_profiler(const char *const *section_names, byte number_of_sections, unsigned long report_interval);
+
+  void start_scan();
+  void measure_section(byte section);
+  void measure_scan(byte section);
+  void send_report(Print &port);
+
+private:
+  // VARIABLES:
+  struct Section_record {
+    unsigned long min_micros;
+    unsigned long max_micros;
+    unsigned long sum_micros;
+    unsigned int count;
+    unsigned int bins[SCAN_PROFILER_NO_OF_BINS];
+  };
+  Section_record _records[SCAN_PROFILER_MAX_SECTIONS];
+  const char *const *_section_names;
+  byte _number_of_sections;
+  byte _next_section_to_report;
+  unsigned long _scan_start_micros;
+  unsigned long _section_start_micros;
+  Insomnia _report_timeout;
+
+  // FUNCTIONS:
+  void add_measurement(byte section, unsigned long runtime);
+  void clear_record(byte section);
+  byte get_bin(unsigned long runtime);
+};
+#endif
@@ -0,0 +1,59 @@
+/*******************************************************************************
+ * settle_time.cpp *************************************************************
+ *******************************************************************************/
+
+#include "settle_time.h"
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Settle_time::Settle_time(unsigned int max_settle_time, unsigned int safety_margin) {
+  _max_settle_time = max_settle_time;
+  _safety_margin = safety_margin;
+  _learned_settle_time = max_settle_time;
+  _no_of_samples = 0;
+  _next_sample = 0;
+  _start_millis = 0;
+}
+
+// COMPLETION ------------------------------------------------------------------
+void Settle_time::start() { _start_millis = millis(); }
+
+bool Settle_time::is_up(bool sensor_has_confirmed) {
+  unsigned long time_elapsed = millis() - _start_millis;
+
+  if (sensor_has_confirmed || time_elapsed >= _max_settle_time) {
+    add_sample(min(time_elapsed, (unsigned long)_max_settle_time));
+    return true;
+  }
+  return false;
+}
+
+unsigned int Settle_time::get_settle_time() { return _learned_settle_time; }
+
+// LEARN SETTLE TIME -----------------------------------------------------------
+void Settle_time::add_sample(unsigned int actuation_time) {
+  _samples[_next_sample] = actuation_time;
+  _next_sample = (_next_sample + 1) % SETTLE_TIME_NO_OF_SAMPLES;
+  if (_no_of_samples < SETTLE_TIME_NO_OF_SAMPLES) {
+    _no_of_samples++;
+  }
+  if (_no_of_samples >= SETTLE_TIME_MIN_NO_OF_SAMPLES) {
+    calculate_settle_time();
+  }
+}
+
+void Settle_time::calculate_settle_time() {
+  // Sort a copy of the samples (insertion sort, max 16 values):
+  unsigned int sorted[SETTLE_TIME_NO_OF_SAMPLES];
+  for (byte i = 0; i < _no_of_samples; i++) {
+    unsigned int value = _samples[i];
+    byte j = i;
+    while (j > 0 && sorted[j - 1] > value) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = value;
+  }
+  unsigned int percentile_90 = sorted[(_no_of_samples - 1) * 9 / 10];
+  unsigned long settle_time = (unsigned long)percentile_90 + _safety_margin;
+  _learned_settle_time = min(settle_time, (unsigned long)_max_settle_time);
+}
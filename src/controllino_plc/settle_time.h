@@ -0,0 +1,54 @@
+/* *****************************************************************************
+ * settle_time.h ***************************************************************
+ * *****************************************************************************
+ * Completion mode for cycle steps that wait for an actuator to move (see the
+ * sensor completion mode of cycle_step.h).
+ * The step is completed as soon as one of the following is true:
+ *
+ * 1) the sensor confirms the end position, the confirmation has to happen
+ *    after start(), e.g. a captured edge
+ * 2) the max settle time has passed (upper bound, same as the fixed delay)
+ *
+ * Every completion is a sample of the actuation time, a stroke that reaches
+ * the upper bound counts as the max settle time. The learned settle time is
+ * the 90th percentile of the last samples plus a safety margin, it is only
+ * calculated after enough samples have been measured.
+ * The step never ends at the learned time without a confirmation: a slow
+ * stroke would be cut off and never sampled, the learned time could only
+ * shrink.
+ * *****************************************************************************
+ */
+
+#ifndef SETTLETIME_H
+#define SETTLETIME_H
+
+#include <Arduino.h>
+
+#define SETTLE_TIME_NO_OF_SAMPLES 16
+#define SETTLE_TIME_MIN_NO_OF_SAMPLES 8
+
+class Settle_time {
+
+public:
+  // FUNCTIONS:
+  Settle_time(unsigned int max_settle_time, unsigned int safety_margin);
+
+  void start();
+  bool is_up(bool sensor_has_confirmed);
+  unsigned int get_settle_time();
+
+private:
+  // VARIABLES:
+  unsigned int _samples[SETTLE_TIME_NO_OF_SAMPLES]; // [ms]
+  byte _no_of_samples;
+  byte _next_sample;
+  unsigned int _max_settle_time;
+  unsigned int _safety_margin;
+  unsigned int _learned_settle_time;
+  unsigned long _start_millis;
+
+  // FUNCTIONS:
+  void add_sample(unsigned int actuation_time);
+  void calculate_settle_time();
+};
+#endif
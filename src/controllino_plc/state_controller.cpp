@@ -71,15 +71,20 @@ bool State_controller::machine_is_running() {
 
 // STEP MANAGEMENT FOR ALL MODES ---------------------------------------------
 void State_controller::switch_to_next_step() {
-  _current_main_cycle_step++;
-  if (_current_main_cycle_step == _number_of_main_cycle_steps) {
-    _current_main_cycle_step = 0;
-  }
+  do {
+    _current_main_cycle_step++;
+    if (_current_main_cycle_step >= _number_of_main_cycle_steps) {
+      _current_main_cycle_step = 0;
+    }
+  } while (step_is_parallel_to_previous(_current_main_cycle_step));
 }
 
 void State_controller::switch_to_previous_step() {
-  if (_current_main_cycle_step > 0) {
+  while (_current_main_cycle_step > 0) {
     _current_main_cycle_step--;
+    if (!step_is_parallel_to_previous(_current_main_cycle_step)) {
+      break;
+    }
   }
 }
 
@@ -89,6 +94,28 @@ int State_controller::get_current_step() {
   return current_cycle_step;
 }
 
+int State_controller::get_last_step_of_current_group() {
+  int last_step = _current_main_cycle_step;
+  while (last_step + 1 < _number_of_main_cycle_steps && step_is_parallel_to_previous(last_step + 1)) {
+    last_step++;
+  }
+  return last_step;
+}
+
+// STEP GROUPS -----------------------------------------------------------------
+void State_controller::set_step_parallel_to_previous(int cycle_step) {
+  if (cycle_step > 0 && cycle_step < 32) {
+    _parallel_steps |= (1UL << cycle_step);
+  }
+}
+
+bool State_controller::step_is_parallel_to_previous(int cycle_step) {
+  if (cycle_step <= 0 || cycle_step >= 32) {
+    return false;
+  }
+  return _parallel_steps & (1UL << cycle_step);
+}
+
 bool State_controller::step_switch_has_happend() {
   bool step_has_changed = (_previous_cycle_step != get_current_step());
   _previous_cycle_step = get_current_step();
@@ -96,3 +123,10 @@ bool State_controller::step_switch_has_happend() {
 }
 
 void State_controller::set_current_step_to(int cycle_step) { _current_main_cycle_step = cycle_step; }
+
+// ELECTROCYLINDER -------------------------------------------------------------
+void State_controller::set_electrocylinder_ready(bool electrocylinder_ready) {
+  _electrocylinder_ready = electrocylinder_ready;
+}
+
+bool State_controller::electrocylinder_is_ready() { return _electrocylinder_ready; }
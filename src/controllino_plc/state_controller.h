@@ -11,6 +11,11 @@
  *
  * 4) reset mode (reset can run independently, on top of other modes)
  * 
+ * STEP GROUPS:
+ * A step can be marked to run parallel to the previous step. Parallel steps
+ * form a group, the current step is always the first step of a group.
+ * Step mode walks one group at a time. (max 32 steps)
+ * 
  * *****************************************************************************
  */
 
@@ -52,8 +57,13 @@ public:
   void switch_to_previous_step();
   void set_current_step_to(int cycle_step);
   int get_current_step();
+  int get_last_step_of_current_group();
+  void set_step_parallel_to_previous(int cycle_step);
+  bool step_is_parallel_to_previous(int cycle_step);
   bool step_switch_has_happend();
 
+  void set_electrocylinder_ready(bool electrocylinder_ready);
+  bool electrocylinder_is_ready();
 
   // VARIABLES:
   // n.a.
@@ -66,11 +76,13 @@ private:
   int _number_of_main_cycle_steps;
   int _current_main_cycle_step;
   int _previous_cycle_step;
+  unsigned long _parallel_steps; // one bit per step
   bool _machine_running;
   bool _step_mode;
   bool _auto_mode;
   bool _reset_mode;
   bool _run_after_reset;
   bool _error_mode;
+  bool _electrocylinder_ready;
 };
 #endif /* StateController_H_ */
@@ -0,0 +1,98 @@
+/*******************************************************************************
+ * step_timer.cpp **************************************************************
+ *******************************************************************************/
+
+#include "step_timer.h"
+#include <common/small_string.h>
+
+const int no_group_running = -1;
+const byte max_record_line_length = 56; // fits into the TX buffer of 64 bytes with the line end
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Step_timer::Step_timer() {
+  _number_of_steps = 0;
+  _running_group = no_group_running;
+  _next_record_step = 0;
+  clear_durations();
+  for (int i = 0; i < STEP_TIMER_MAX_STEPS; i++) {
+    _record[i] = 0;
+  }
+}
+
+void Step_timer::set_no_of_steps(int number_of_steps) {
+  _number_of_steps = min(number_of_steps, STEP_TIMER_MAX_STEPS);
+  _next_record_step = _number_of_steps; // nothing to send before the first cycle
+}
+
+// Call when a cycle is aborted, e.g. by a reset:
+void Step_timer::clear_durations() {
+  for (int i = 0; i < STEP_TIMER_MAX_STEPS; i++) {
+    _step_durations[i] = 0;
+  }
+}
+
+// ENTRY AND EXIT OF A STEP ----------------------------------------------------
+// Call every time the group runs, only the first call sets the entry time:
+void Step_timer::set_group_running(int first_step) {
+  if (_running_group != first_step) {
+    _running_group = first_step;
+    _step_entry_millis = millis();
+  }
+}
+
+void Step_timer::set_step_completed(int step) {
+  if (_running_group != no_group_running && step >= _running_group && step < _number_of_steps) {
+    _step_durations[step] = millis() - _step_entry_millis;
+  }
+}
+
+// Call when the group has been completed or aborted:
+void Step_timer::stop_timing() { _running_group = no_group_running; }
+
+// Call when the cycle wraps back to step 0, a record not yet sent is replaced:
+void Step_timer::close_cycle() {
+  for (int i = 0; i < _number_of_steps; i++) {
+    _record[i] = _step_durations[i];
+  }
+  _next_record_step = 0;
+  clear_durations();
+}
+
+// GETTER ----------------------------------------------------------------------
+unsigned long Step_timer::get_step_duration(int step) {
+  if (step < 0 || step >= _number_of_steps) {
+    return 0;
+  }
+  return _record[step];
+}
+
+// REPORT ----------------------------------------------------------------------
+// Call every scan, sends at most one line:
+void Step_timer::send_record(HardwareSerial &port) {
+  if (_next_record_step >= _number_of_steps) {
+    return;
+  }
+  Small_string<64> line;
+  line.print("LOG;STEP_TIMES;");
+  line.print(_next_record_step);
+  line.print(";");
+  int step = _next_record_step;
+  while (step < _number_of_steps) {
+    Small_string<12> duration;
+    if (step != _next_record_step) {
+      duration.print(",");
+    }
+    duration.print(_record[step]);
+    if (line.length() + duration.length() > max_record_line_length) {
+      break;
+    }
+    line.print(duration.c_str());
+    step++;
+  }
+  line.print(";\r\n");
+  if (port.availableForWrite() < line.length()) {
+    return;
+  }
+  port.print(line.c_str());
+  _next_record_step = step;
+}
@@ -0,0 +1,50 @@
+/* *****************************************************************************
+ * step_timer.h ****************************************************************
+ * *****************************************************************************
+ * Measures how long every step of the main cycle takes.
+ * A step is timed from the first run of its step group until it is completed,
+ * the time the machine waits in step mode between two groups is not counted.
+ *
+ * close_cycle() takes a record of the durations when the cycle wraps back to
+ * step 0 and clears them for the next cycle, clear_durations() drops an
+ * aborted cycle. A step that has not been completed in the cycle is sent as
+ * 0, never with the time of an old cycle.
+ *
+ * send_record() sends the record in complete lines that fit into the free TX
+ * buffer, so it never blocks the loop:
+ * LOG;STEP_TIMES;<index of the first step>;<duration>,<duration>,...; [ms]
+ * *****************************************************************************
+ */
+
+#ifndef STEPTIMER_H
+#define STEPTIMER_H
+
+#include <Arduino.h>
+
+#define STEP_TIMER_MAX_STEPS 32
+
+class Step_timer {
+
+public:
+  // FUNCTIONS:
+  Step_timer();
+
+  void set_no_of_steps(int number_of_steps);
+  void set_group_running(int first_step);
+  void set_step_completed(int step);
+  void stop_timing();
+  void close_cycle();
+  void clear_durations();
+  void send_record(HardwareSerial &port);
+  unsigned long get_step_duration(int step); // of the last closed cycle
+
+private:
+  // VARIABLES:
+  unsigned long _step_durations[STEP_TIMER_MAX_STEPS]; // [ms]
+  unsigned long _record[STEP_TIMER_MAX_STEPS]; // [ms] of the last closed cycle
+  int _next_record_step; // to send, _number_of_steps when sent
+  unsigned long _step_entry_millis;
+  int _number_of_steps;
+  int _running_group;
+};
+#endif
@@ -0,0 +1,117 @@
+/*******************************************************************************
+ * touch_dispatcher.cpp ********************************************************
+ *******************************************************************************/
+
+#include "touch_dispatcher.h"
+
+const byte touch_event_start = 0x65;
+const byte touch_event_push = 0x01;
+const byte touch_event_pop = 0x00;
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Touch_dispatcher::Touch_dispatcher(const Touch_binding *bindings_in_flash, byte no_of_bindings) {
+  _bindings = bindings_in_flash;
+  _no_of_bindings = no_of_bindings;
+  _frame_length = 0;
+  _idle_micros = 0;
+  _frame_start_micros = 0;
+  _last_latency = 0;
+  _max_latency = 0;
+  _no_of_events = 0;
+  _no_of_unknown_events = 0;
+}
+
+// RECEIVE ---------------------------------------------------------------------
+void Touch_dispatcher::receive_events(HardwareSerial &port) {
+  if (!port.available()) {
+    if (_frame_length == 0) {
+      _idle_micros = micros();
+    }
+    return;
+  }
+
+  while (port.available()) {
+    byte c = port.read();
+    if (_frame_length == 0) {
+      if (c != touch_event_start) {
+        continue; // not the start of a touch event
+      }
+      _frame_start_micros = _idle_micros;
+    }
+    _frame[_frame_length++] = c;
+
+    if (_frame_length == sizeof(_frame)) {
+      if (_frame[4] == 0xff && _frame[5] == 0xff && _frame[6] == 0xff) {
+        dispatch_frame();
+        _frame_length = 0;
+      } else {
+        resync_frame();
+      }
+    }
+  }
+  if (_frame_length == 0) {
+    _idle_micros = micros();
+  }
+}
+
+// Without terminator the 0x65 was not the start of a touch event (e.g. a byte
+// of another frame), the event may start at a later byte that is already buffered:
+void Touch_dispatcher::resync_frame() {
+  byte start = 1;
+  while (start < _frame_length && _frame[start] != touch_event_start) {
+    start++;
+  }
+  for (byte i = start; i < _frame_length; i++) {
+    _frame[i - start] = _frame[i];
+  }
+  _frame_length -= start;
+}
+
+void Touch_dispatcher::dispatch_frame() {
+  Touch_binding binding;
+  if (!find_binding(_frame[1], _frame[2], binding)) {
+    _no_of_unknown_events++;
+    return;
+  }
+  _no_of_events++;
+  _last_latency = micros() - _frame_start_micros;
+  _max_latency = max(_max_latency, _last_latency);
+
+  if (_frame[3] == touch_event_push && binding.push) {
+    binding.push(NULL);
+  } else if (_frame[3] == touch_event_pop && binding.pop) {
+    binding.pop(NULL);
+  }
+}
+
+bool Touch_dispatcher::find_binding(byte page, byte component, Touch_binding &binding) {
+  unsigned int key = (page << 8) | component;
+  int first = 0;
+  int last = _no_of_bindings - 1;
+  while (first <= last) {
+    int middle = (first + last) / 2;
+    unsigned int middle_key = pgm_read_byte(&_bindings[middle].page) << 8;
+    middle_key |= pgm_read_byte(&_bindings[middle].component);
+    if (middle_key == key) {
+      memcpy_P(&binding, &_bindings[middle], sizeof(binding));
+      return true;
+    }
+    if (middle_key < key) {
+      first = middle + 1;
+    } else {
+      last = middle - 1;
+    }
+  }
+  return false;
+}
+
+// GETTER ----------------------------------------------------------------------
+unsigned long Touch_dispatcher::get_last_latency() { return _last_latency; }
+
+unsigned long Touch_dispatcher::get_max_latency() { return _max_latency; }
+
+void Touch_dispatcher::clear_max_latency() { _max_latency = 0; }
+
+unsigned long Touch_dispatcher::get_no_of_events() { return _no_of_events; }
+
+unsigned long Touch_dispatcher::get_no_of_unknown_events() { return _no_of_unknown_events; }
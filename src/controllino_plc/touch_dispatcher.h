@@ -0,0 +1,69 @@
+/* *****************************************************************************
+ * touch_dispatcher.h **********************************************************
+ * *****************************************************************************
+ * Receives the touch events of the Nextion display and calls their handlers.
+ * Replaces nexLoop(), which waits 10ms for every received byte and searches
+ * a linear listen list.
+ *
+ * A touch event frame is: 0x65 <page> <component> <event> 0xff 0xff 0xff
+ * (event 0x01 = push, 0x00 = pop). The bytes are parsed as they arrive from
+ * the RX buffer, a frame can be spread over several scans. Other frames of
+ * the display are skipped. If the 7 bytes from a 0x65 have no terminator,
+ * parsing restarts at the next 0x65 among them. Without received bytes
+ * nothing is done.
+ *
+ * The handlers are looked up in a table in flash by binary search,
+ * THE TABLE HAS TO BE SORTED BY PAGE, THEN BY COMPONENT ID !
+ *
+ * Latency: time from the last scan without pending bytes to the call of the
+ * handler, i.e. an upper bound of the time an event waits before it is handled.
+ * *****************************************************************************
+ */
+
+#ifndef TOUCHDISPATCHER_H
+#define TOUCHDISPATCHER_H
+
+#include <Arduino.h>
+
+typedef void (*Touch_handler)(void *ptr);
+
+struct Touch_binding {
+  byte page;
+  byte component;
+  Touch_handler push;
+  Touch_handler pop;
+};
+
+class Touch_dispatcher {
+
+public:
+  // FUNCTIONS:
+  Touch_dispatcher(const Touch_binding *bindings_in_flash, byte no_of_bindings);
+
+  void receive_events(HardwareSerial &port);
+
+  unsigned long get_last_latency();
+  unsigned long get_max_latency();
+  void clear_max_latency();
+  unsigned long get_no_of_events();
+  unsigned long get_no_of_unknown_events();
+
+private:
+  // VARIABLES:
+  const Touch_binding *_bindings;
+  byte _no_of_bindings;
+  byte _frame[7];
+  byte _frame_length;
+  unsigned long _idle_micros;
+  unsigned long _frame_start_micros;
+  unsigned long _last_latency;
+  unsigned long _max_latency;
+  unsigned long _no_of_events;
+  unsigned long _no_of_unknown_events;
+
+  // FUNCTIONS:
+  void resync_frame();
+  void dispatch_frame();
+  bool find_binding(byte page, byte component, Touch_binding &binding);
+};
+#endif
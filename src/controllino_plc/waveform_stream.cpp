@@ -0,0 +1,107 @@
+/*******************************************************************************
+ * waveform_stream.cpp *********************************************************
+ *******************************************************************************/
+
+#include "waveform_stream.h"
+#include <common/small_string.h>
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Waveform_stream::Waveform_stream(byte component_id, byte channel, unsigned int sample_interval,
+                                 unsigned int bytes_per_second, long full_scale_value) {
+  _component_id = component_id;
+  _channel = channel;
+  _sample_interval = sample_interval;
+  _bytes_per_second = bytes_per_second;
+  _full_scale_value = full_scale_value;
+  _is_running = false;
+  _interval_has_sample = false;
+  _interval_max_value = 0;
+  _interval_start_millis = 0;
+  _budget_update_millis = 0;
+  _budget_bytes = 0;
+  _no_of_points_sent = 0;
+  _no_of_points_skipped = 0;
+}
+
+// START AND STOP --------------------------------------------------------------
+void Waveform_stream::start() {
+  _is_running = true;
+  _interval_has_sample = false;
+  _interval_start_millis = millis();
+  _budget_update_millis = millis();
+  _budget_bytes = 0;
+}
+
+void Waveform_stream::stop() { _is_running = false; }
+
+void Waveform_stream::clear(Nextion_queue &queue) {
+  queue.print("cle ");
+  queue.print(_component_id);
+  queue.print(",");
+  queue.print(_channel);
+  queue.end_command();
+}
+
+// SAMPLES ---------------------------------------------------------------------
+void Waveform_stream::add_sample(long value, bool display_is_visible, Nextion_queue &queue) {
+  if (!_is_running) {
+    return;
+  }
+  if (!_interval_has_sample || value > _interval_max_value) {
+    _interval_max_value = value;
+    _interval_has_sample = true;
+  }
+  if (millis() - _interval_start_millis < _sample_interval) {
+    return;
+  }
+  _interval_start_millis += _sample_interval;
+  // Do not send a burst of points after a long scan:
+  if (millis() - _interval_start_millis >= _sample_interval) {
+    _interval_start_millis = millis();
+  }
+  _interval_has_sample = false;
+
+  update_budget();
+  if (display_is_visible) {
+    send_point(_interval_max_value, queue);
+  }
+}
+
+// The budget fills up continuously, at most a quarter of a second is saved up:
+void Waveform_stream::update_budget() {
+  unsigned long now = millis();
+  _budget_bytes += long(now - _budget_update_millis) * _bytes_per_second / 1000;
+  _budget_update_millis = now;
+  long max_budget_bytes = _bytes_per_second / 4;
+  if (_budget_bytes > max_budget_bytes) {
+    _budget_bytes = max_budget_bytes;
+  }
+}
+
+void Waveform_stream::send_point(long value, Nextion_queue &queue) {
+  long clipped_value = max(0L, min(value, _full_scale_value));
+  long point = clipped_value * 255 / _full_scale_value; // the waveform shows 0..255
+
+  Small_string<16> command;
+  command.print("add ");
+  command.print(_component_id);
+  command.print(",");
+  command.print(_channel);
+  command.print(",");
+  command.print(point);
+  long command_bytes = command.length() + 3; // terminated by 0xff 0xff 0xff
+
+  if (_budget_bytes < command_bytes) {
+    _no_of_points_skipped++;
+    return;
+  }
+  _budget_bytes -= command_bytes;
+  queue.print(command.c_str());
+  queue.end_command(priority_process, false); // every point is a new command, never replace one
+  _no_of_points_sent++;
+}
+
+// GETTER ----------------------------------------------------------------------
+bool Waveform_stream::is_running() { return _is_running; }
+unsigned long Waveform_stream::get_no_of_points_sent() { return _no_of_points_sent; }
+unsigned long Waveform_stream::get_no_of_points_skipped() { return _no_of_points_skipped; }
@@ -0,0 +1,58 @@
+/* *****************************************************************************
+ * waveform_stream.h ***********************************************************
+ * *****************************************************************************
+ * Streams a measured value to a Nextion waveform component.
+ *
+ * Every scan a sample can be added, the samples are decimated to one point per
+ * sample interval (the biggest sample of the interval, so short peaks and
+ * stalls stay visible). Every point is sent with "add <id>,<channel>,<0-255>".
+ * The display traffic is limited by a byte budget per second, a point that
+ * does not fit into the budget is skipped and counted.
+ * Points are only added between start() and stop(), clear() erases the curve.
+ * *****************************************************************************
+ */
+
+#ifndef WAVEFORMSTREAM_H
+#define WAVEFORMSTREAM_H
+
+#include <Arduino.h>
+#include <controllino_plc/nextion_queue.h>
+
+class Waveform_stream {
+
+public:
+  // FUNCTIONS:
+  Waveform_stream(byte component_id, byte channel, unsigned int sample_interval, unsigned int bytes_per_second,
+                  long full_scale_value);
+
+  void start();
+  void stop();
+  void add_sample(long value, bool display_is_visible, Nextion_queue &queue);
+  void clear(Nextion_queue &queue);
+
+  // GETTER:
+  bool is_running();
+  unsigned long get_no_of_points_sent();
+  unsigned long get_no_of_points_skipped();
+
+private:
+  // VARIABLES:
+  byte _component_id;
+  byte _channel;
+  unsigned int _sample_interval; // [ms]
+  unsigned int _bytes_per_second;
+  long _full_scale_value; // shown as 255
+  bool _is_running;
+  bool _interval_has_sample;
+  long _interval_max_value;
+  unsigned long _interval_start_millis;
+  unsigned long _budget_update_millis;
+  long _budget_bytes;
+  unsigned long _no_of_points_sent;
+  unsigned long _no_of_points_skipped;
+
+  // FUNCTIONS:
+  void update_budget();
+  void send_point(long value, Nextion_queue &queue);
+};
+#endif
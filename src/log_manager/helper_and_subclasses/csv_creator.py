@@ -54,13 +54,22 @@ class csv_creator():
         log_list.append(["File creation time:", datetime.now().strftime("%H:%M:%S")])
         log_list.append([])
         
-        log_list.append(["", "total testrig cycles", "cycles since last counter reset", "maximum force", "peak battery current", "peak battery current"])
+        log_list.append(["", "total testrig cycles", "cycles since last counter reset", "maximum force", "peak battery current", "peak battery current",
+                         "duration of every cycle step", "force profile", "", "", "", "", "", "",
+                         "tension stroke", "", "", "crimp stroke", "", "",
+                         "sensor travel times", "input capture"])
         
         # Add column header
-        log_list.append(["TIMESTAMP", "CYCLES TOTAL", "CYCLES RESET", "TENSION FORCE", "TENSION CURRENT", "CRIMP CURRENT"])
+        log_list.append(["TIMESTAMP", "CYCLES TOTAL", "CYCLES RESET", "TENSION FORCE", "TENSION CURRENT", "CRIMP CURRENT",
+                         "STEP TIMES", "PEAK", "TIME TO PEAK", "RISE TIME", "PLATEAU", "SAMPLES", "STORED", "INTERVAL",
+                         "CHARGE", "ENERGY", "DURATION", "CHARGE", "ENERGY", "DURATION",
+                         "TRAVEL TIMES", "LOST EDGES"])
     
         # Add unit header
-        log_list.append(["", "", "", "[N]", "[A]", "[A]"])
+        log_list.append(["", "", "", "[N]", "[A]", "[A]",
+                         "[ms]", "[N]", "[ms]", "[ms]", "[N]", "", "", "[ms]",
+                         "[As]", "[J]", "[s]", "[As]", "[J]", "[s]",
+                         "[ms]", ""])
 
         # Get log values
         for timestamp in logs:
@@ -72,7 +81,8 @@ class csv_creator():
             csv_tension_force = values[2]
             csv_tension_current = values[3]
             csv_crimp_current = values[4]
-            log_list.append([csv_timestamp, csv_cycle_total, csv_cycle_reset, csv_tension_force, csv_tension_current, csv_crimp_current])
+            csv_cycle_details = values[5:22] # empty for logs recorded before these fields were added
+            log_list.append([csv_timestamp, csv_cycle_total, csv_cycle_reset, csv_tension_force, csv_tension_current, csv_crimp_current] + csv_cycle_details)
         for log in log_list:
             print(log)
 
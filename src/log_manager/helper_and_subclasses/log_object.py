@@ -10,8 +10,13 @@ class log_object:
         self._tension_force = 0
         self._tension_current = 0
         self._crimp_current = 0
+        self._tension_stroke = ""
+        self._crimp_stroke = ""
         self._tool_is_tensioning = False
         self._tool_is_crimping = False
+        self._step_times = ""
+        self._force_profile = ""
+        self._travel_times = ""
 
     def reset_log(self):
         self._cycle_total = 0
@@ -19,8 +24,13 @@ class log_object:
         self._tension_force = 0
         self._tension_current = 0
         self._crimp_current = 0
+        self._tension_stroke = ""
+        self._crimp_stroke = ""
         self._tool_is_tensioning = False
         self._tool_is_crimping = False
+        self._step_times = ""
+        self._force_profile = ""
+        self._travel_times = ""
 
     def set_tool_is_tensioning(self):
         self.tool_is_crimping = False
@@ -39,6 +49,11 @@ class log_object:
         print(f'tensioning force: {self._tension_force}N')
         print(f'tensioning current: {self._tension_current}A')
         print(f'crimping current: {self._crimp_current}A')
+        print(f'tensioning stroke (charge;energy;duration): {self._tension_stroke} (As;J;s)')
+        print(f'crimping stroke (charge;energy;duration): {self._crimp_stroke} (As;J;s)')
+        print(f'step times: {self._step_times}ms')
+        print(f'force profile (peak;ttp;rise;plateau;samples;stored;interval): {self._force_profile}')
+        print(f'travel times (foerderzylinder,messer,sledge;lost edges): {self._travel_times}')
         print('---------------------------------')
 
     def get_db_string(self):
@@ -46,6 +61,12 @@ class log_object:
         key = datetime.now().strftime("%Y-%m-%d %H:%M:%S")
         key=f"logs/{key}"
         spaghettilog = f"{self._cycle_total};{self._cycle_reset};{self._tension_force};{self._tension_current};{self._crimp_current};"
+        # Appended fields, a missing value keeps its empty fields so the positions stay fixed:
+        spaghettilog += self.get_fields(self._step_times, 1) # durations separated by ','
+        spaghettilog += self.get_fields(self._force_profile, 7) # peak;ttp;rise;plateau;samples;stored;interval
+        spaghettilog += self.get_fields(self._tension_stroke, 3) # charge;energy;duration
+        spaghettilog += self.get_fields(self._crimp_stroke, 3) # charge;energy;duration
+        spaghettilog += self.get_fields(self._travel_times, 2) # times separated by ',';lost edges
         print(spaghettilog)
         db_string = {
             # "time": timestamp,
@@ -58,6 +79,11 @@ class log_object:
         }
         return db_string
 
+    def get_fields(self, value, no_of_fields):
+        fields = str(value).split(';')[:no_of_fields]
+        fields += [''] * (no_of_fields - len(fields))
+        return ';'.join(fields) + ';'
+
     # GETTER -------------------------------------------------------------------
 
     @ property
@@ -80,6 +106,14 @@ class log_object:
     def crimp_current(self):
         return self._crimp_current
 
+    @ property
+    def tension_stroke(self):
+        return self._tension_stroke
+
+    @ property
+    def crimp_stroke(self):
+        return self._crimp_stroke
+
     @ property
     def tool_is_tensioning(self):
         return self._tool_is_tensioning
@@ -88,6 +122,18 @@ class log_object:
     def tool_is_crimping(self):
         return self._tool_is_crimping
 
+    @ property
+    def step_times(self):
+        return self._step_times
+
+    @ property
+    def force_profile(self):
+        return self._force_profile
+
+    @ property
+    def travel_times(self):
+        return self._travel_times
+
     # SETTER -------------------------------------------------------------------
 
     @ cycle_total.setter
@@ -110,6 +156,14 @@ class log_object:
     def crimp_current(self, crimp_current):
         self._crimp_current = crimp_current
 
+    @ tension_stroke.setter
+    def tension_stroke(self, tension_stroke):
+        self._tension_stroke = tension_stroke
+
+    @ crimp_stroke.setter
+    def crimp_stroke(self, crimp_stroke):
+        self._crimp_stroke = crimp_stroke
+
     @ tool_is_tensioning.setter
     def tool_is_tensioning(self, tool_is_tensioning):
         self._tool_is_tensioning = tool_is_tensioning
@@ -117,3 +171,15 @@ class log_object:
     @ tool_is_crimping.setter
     def tool_is_crimping(self, tool_is_crimping):
         self._tool_is_crimping = tool_is_crimping
+
+    @ step_times.setter
+    def step_times(self, step_times):
+        self._step_times = step_times
+
+    @ force_profile.setter
+    def force_profile(self, force_profile):
+        self._force_profile = force_profile
+
+    @ travel_times.setter
+    def travel_times(self, travel_times):
+        self._travel_times = travel_times
@@ -5,6 +5,7 @@ import sys
 import time
 import serial
 import serial.tools.list_ports
+from datetime import datetime
 from helper_and_subclasses.log_object import log_object
 from helper_and_subclasses.serial_scanner import serial_scanner
 from helper_and_subclasses.firebase_helper import firebase_helper
@@ -17,6 +18,7 @@ The "Controllino PLC" provides the "RPI Log Manager" with following info:
     • start of tensioning
     • tension force
     • start of crimping
+    • duration of every cycle step
 
 The "Arduino Current Logger" provides the "RPI Log Manager" with following info:
     • peak current after rising above a certain current threshold
@@ -46,6 +48,7 @@ class log_manager():
         self.arduino_pid = 24577  # Arduino Uno: 67
         self.arduino_port = 0
         self.arduino_serial = 0
+        self.arduino_received = b''  # incomplete line, completed by the next read
 
         # CONTROLLINO:
         # The USB-Serial-Converter is connected to Controllino TX1/RX1
@@ -53,6 +56,7 @@ class log_manager():
         self.usb_serial_converter_pid = 8963
         self.controllino_port = 0
         self.controllino_serial = 0
+        self.controllino_received = b''  # incomplete line, completed by the next read
         # self.controllino_vid=9025 # replaced by serial converter
         # self.controllino_pid=66 # replaced by serial converter
 
@@ -61,6 +65,17 @@ class log_manager():
         self.firebase_helper = firebase_helper()
         self.email_helper = email_helper()
 
+        # INPUT TRACE (controllino built with -D TRACE_INPUTS):
+        # replay with the native simulation: --replay-trace input_trace.log
+        self.trace_file_path = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'input_trace.log')
+
+        # CURVES (one line per stroke, the header line before the curve gives the length and interval):
+        # force curves of the controllino in N, current curves of the arduino in 0.01A
+        self.curves = {
+            'FORCE_CURVE': self.create_curve('force_curves.log'),
+            'CURRENT_CURVE': self.create_curve('current_curves.log')
+        }
+
     def get_list_of_serial_devices(self):
         self.serial_scanner.print_list_of_serial_devices()
 
@@ -80,11 +95,13 @@ class log_manager():
         self.arduino_port_is_available = False
         self.arduino_port_is_connected = False
         self.arduino_serial = 0
+        self.arduino_received = b''
 
     def reset_controllino_connection(self):
         self.controllino_port_is_available = False
         self.controllino_port_is_connected = False
         self.controllino_serial = 0
+        self.controllino_received = b''
 
     def get_port_of_arduino(self):
         if(self.arduino_port_is_available == False):
@@ -166,6 +183,12 @@ class log_manager():
         readline = readline.decode('utf-8')
         if(readline == ""):
             return
+        if(readline.startswith('TRACES;')):
+            self.add_line_to_trace(readline)
+            return
+        if(readline.startswith('LOG;FORCE_CURVE;') or readline.startswith('LOG;CURRENT_CURVE;')):
+            self.add_curve_line(readline.split(';'))
+            return
         print(readline)
         readline = readline.split(';')
 
@@ -175,6 +198,38 @@ class log_manager():
         if(readline[0] == 'EMAIL'):
             self.send_email(readline)
 
+    def add_line_to_trace(self, readline):
+        with open(self.trace_file_path, 'a') as trace_file:
+            trace_file.write(readline.strip() + '\n')
+
+    def create_curve(self, file_name):
+        file_path = os.path.join(os.path.dirname(os.path.abspath(__file__)), file_name)
+        return {'file_path': file_path, 'header': '', 'length': 0, 'values': []}
+
+    def start_curve(self, key, header, length):
+        curve = self.curves[key]
+        curve['header'] = header
+        curve['length'] = length
+        curve['values'] = []
+
+    def add_curve_line(self, readline):
+        # LOG;<KEY>;<index of the first value>;<delta>,<delta>,...;
+        curve = self.curves[readline[1]]
+        if int(readline[2]) == 0:
+            curve['values'] = []
+        value = curve['values'][-1] if curve['values'] else 0
+        for delta in readline[3].split(','):
+            value += int(delta)
+            curve['values'].append(value)
+        if len(curve['values']) >= curve['length']:
+            self.write_curve(curve)
+
+    def write_curve(self, curve):
+        with open(curve['file_path'], 'a') as curve_file:
+            timestamp = datetime.now().strftime("%Y/%m/%d %H:%M:%S")
+            curve_file.write(f"{timestamp};{curve['header']};" + ','.join(map(str, curve['values'])) + '\n')
+        curve['values'] = []
+
     def upload_log(self):
         data = self.log_object.get_db_string()
         self.firebase_helper.push(data)
@@ -213,16 +268,50 @@ class log_manager():
         if readline[1] == 'START_CRIMP':
             self.log_object.set_tool_is_crimping()
 
+        if readline[1] == 'STEP_TIMES':
+            # index of the first step;durations separated by ',' (one record in several lines)
+            if int(readline[2]) == 0:
+                self.log_object.step_times = readline[3]
+            else:
+                self.log_object.step_times += ',' + readline[3]
+
+        if readline[1] == 'TRAVEL_TIMES':
+            # foerderzylinder,messer,sledge;lost edges
+            self.log_object.travel_times = ';'.join(readline[2:4])
+
+        if readline[1] == 'FORCE_PROFILE':
+            # peak;time to peak;rise time;plateau mean;samples;stored samples;interval
+            # the curve has the stored samples, the last ones of a long stroke
+            self.log_object.force_profile = ';'.join(readline[2:9])
+            self.start_curve('FORCE_CURVE', self.log_object.force_profile, int(readline[7]))
+
+        if readline[1] == 'CURRENT_STROKE':
+            # stored points;stroke points;interval;pre trigger points;truncated
+            self.start_curve('CURRENT_CURVE', ';'.join(readline[2:7]), int(readline[2]))
+
         if readline[1] == 'CURRENT_MAX':
+            # current;charge;energy;duration
+            stroke = ';'.join(readline[3:6])
             if(self.log_object.tool_is_tensioning):
                 self.log_object.tension_current = readline[2]
+                self.log_object.tension_stroke = stroke
             if(self.log_object.tool_is_crimping):
                 self.log_object.crimp_current = readline[2]
+                self.log_object.crimp_stroke = stroke
+
+    def read_complete_lines(self, port_serial, received):
+        # Reads everything that has arrived, so every line is processed in the loop it arrived in.
+        # Returns the complete lines and the incomplete rest:
+        received += port_serial.read(port_serial.in_waiting)
+        *lines, received = received.split(b'\n')
+        return [line + b'\n' for line in lines], received
 
     def read_arduino_serial(self):
         if(self.arduino_serial):
             try:
-                log_manager.process_serial_read(self.arduino_serial.readline())
+                lines, self.arduino_received = self.read_complete_lines(self.arduino_serial, self.arduino_received)
+                for line in lines:
+                    log_manager.process_serial_read(line)
             except Exception as error:
                 error_message = 'CAUGHT AN ERROR WHILE TRYING TO READ ARDUINO SERIAL'
                 print(error_message, error)
@@ -231,7 +320,9 @@ class log_manager():
     def read_controllino_serial(self):
         if(self.controllino_serial):
             try:
-                log_manager.process_serial_read(self.controllino_serial.readline())
+                lines, self.controllino_received = self.read_complete_lines(self.controllino_serial, self.controllino_received)
+                for line in lines:
+                    log_manager.process_serial_read(line)
             except Exception as error:
                 error_message = 'CAUGHT AN ERROR WHILE TRYING TO READ CONTROLLINO SERIAL'
                 print(error_message, error)
@@ -265,6 +356,6 @@ if __name__ == '__main__':
             error_message = 'CAUGHT AN ERROR IN THE MAIN LOOP, THIS SHOULD NOT HAPPEN !!!'
             print(error_message, error)
 
-        time.sleep(0.5)
+        time.sleep(0.1)
 
     ser.close()
@@ -0,0 +1,95 @@
+/*******************************************************************************
+ * conversion_benchmark.cpp ****************************************************
+ *******************************************************************************/
+
+#include "conversion_benchmark.h"
+#include <chrono>
+#include <common/sensor_conversion.h>
+#include <cstdio>
+
+extern Sensor_conversion force_conversion;
+extern Sensor_conversion temperature_conversion;
+
+// FLOAT REFERENCES (THE REPLACED FIRMWARE CALCULATIONS) ***********************
+
+int reference_force(int adc_value) {
+  float sensor_voltage = adc_value * 0.03f;
+  float pressure = sensor_voltage / 10.0f * 10.0f;
+  float float_force = 15080.0f * pressure / 10.0f;
+  return int(float_force);
+}
+
+int reference_temperature(int adc_value) {
+  float sensor_voltage = adc_value * 0.03f;
+  float temperature = sensor_voltage / 10.0f * 200.0f;
+  return int(temperature);
+}
+
+long reference_centiamps(int adc_value) {
+  float amps = float(adc_value) / 1024.0f * 100.0f;
+  return long(amps * 100.0f);
+}
+
+Sensor_conversion current_conversion(make_fixed_point_scale(100.0 * 100 / 1024, 1023), 2048);
+
+// CHECKS **********************************************************************
+
+volatile long benchmark_sink;
+
+template <typename Reference>
+bool compare_conversion(const char *name, Reference reference, Sensor_conversion &conversion) {
+  long max_difference = 0;
+  for (int adc_value = 0; adc_value < 1024; adc_value++) {
+    long difference = labs(conversion.convert(adc_value) - long(reference(adc_value)));
+    max_difference = max(max_difference, difference);
+  }
+
+  const int repetitions = 2000;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repetitions; i++) {
+    for (int adc_value = 0; adc_value < 1024; adc_value++) {
+      benchmark_sink = reference(adc_value);
+    }
+  }
+  auto middle = std::chrono::steady_clock::now();
+  for (int i = 0; i < repetitions; i++) {
+    for (int adc_value = 0; adc_value < 1024; adc_value++) {
+      benchmark_sink = conversion.convert(adc_value);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  double conversions = double(repetitions) * 1024;
+  double float_ns = std::chrono::duration<double, std::nano>(middle - start).count() / conversions;
+  double fixed_ns = std::chrono::duration<double, std::nano>(end - middle).count() / conversions;
+
+  Fixed_point_scale scale = conversion.get_scale();
+  printf("%-12s factor %8ld >> %2d   max difference %ld   float %5.2f ns   fixed %5.2f ns\n", name, scale.factor,
+         scale.shift, max_difference, float_ns, fixed_ns);
+  return max_difference <= 1;
+}
+
+bool check_calibration() {
+  const Calibration_point points[] = {{0, 0}, {100, 1000}, {1023, 1100}};
+  bool is_ok = current_conversion.store_calibration(points, 3);
+  is_ok = is_ok && current_conversion.convert(50) == 500 && current_conversion.convert(1023) == 1100;
+  current_conversion.load_calibration(); // as after a restart
+  is_ok = is_ok && current_conversion.is_calibrated() && current_conversion.convert(100) == 1000;
+  const Calibration_point unsorted_points[] = {{100, 0}, {50, 10}};
+  is_ok = is_ok && !current_conversion.store_calibration(unsorted_points, 2);
+  current_conversion.clear_calibration();
+  current_conversion.load_calibration();
+  is_ok = is_ok && !current_conversion.is_calibrated();
+  printf("calibration  store / load / interpolate / clear: %s\n", is_ok ? "ok" : "FAILED");
+  return is_ok;
+}
+
+bool run_conversion_benchmark() {
+  printf("-----------------------------------------------------------\n");
+  printf("SENSOR CONVERSIONS (ADC 0-1023, FIXED POINT VS FLOAT)\n");
+  bool is_ok = compare_conversion("force [N]", reference_force, force_conversion);
+  is_ok = compare_conversion("temp [C]", reference_temperature, temperature_conversion) && is_ok;
+  is_ok = compare_conversion("curr [0.01A]", reference_centiamps, current_conversion) && is_ok;
+  is_ok = check_calibration() && is_ok;
+  printf("-----------------------------------------------------------\n");
+  return is_ok;
+}
@@ -0,0 +1,20 @@
+/* *****************************************************************************
+ * conversion_benchmark.h ******************************************************
+ * *****************************************************************************
+ * Compares the fixed point sensor conversions of the firmware with the float
+ * calculations they replace, for every ADC value 0-1023:
+ * - largest difference (must not exceed one unit)
+ * - host time per conversion, float and fixed point
+ * - store, load and clear of a calibration table in the EEPROM shim
+ *
+ * The host has an FPU, on the AVR the float calculation is emulated in
+ * software and the difference is much bigger.
+ * *****************************************************************************
+ */
+
+#ifndef CONVERSIONBENCHMARK_H
+#define CONVERSIONBENCHMARK_H
+
+bool run_conversion_benchmark(); // true if all checks pass
+
+#endif
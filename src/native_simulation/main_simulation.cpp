@@ -0,0 +1,408 @@
+/*
+ * *****************************************************************************
+ * RIG-SEALLESS NATIVE SIMULATION
+ * *****************************************************************************
+ * Runs the controllino PLC firmware on the host against a virtual rig.
+ * The virtual clock only advances by the simulated scan time, delay() calls
+ * and blocking serial writes, so thousands of cycles run per second.
+ * -----------------------------------------------------------------------------
+ * USAGE:
+ * pio run -e native && .pio/build/native/program [options]
+ *
+ * --cycles <n>                number of machine cycles to run (default 1000)
+ * --scan-us <n>               runtime of one loop without I/O (default 250)
+ * --pause-s <n>               cycle duration set on page 2 (default 0)
+ * --stall-feed-at-cycle <n>   block the feed cylinder for 30s in cycle n
+ * --panel-max-baud <n>        fastest baud rate the display accepts (default 115200)
+ * --record-trace <file>       write the input trace of the virtual rig to file
+ * --replay-trace <file>       drive the inputs from a recorded trace instead
+ *                             of the virtual rig, runs until the trace ends
+ * --verbose                   print all serial output
+ * --benchmark-conversions     compare the sensor conversions with the float
+ *                             calculations and exit (1 if they differ)
+ * --benchmark-peak-tracker    compare the current peak detection of the logger
+ *                             with the replaced RunningMedian and exit
+ * *****************************************************************************
+ */
+
+#include "conversion_benchmark.h"
+#include "peak_tracker_benchmark.h"
+#include "trace_player.h"
+#include "virtual_hardware.h"
+#include "virtual_rig.h"
+#include <EEPROM_Counter.h>
+#include <controllino_plc/state_controller.h>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// FIRMWARE INTERFACE **********************************************************
+
+void setup();
+void loop();
+extern EEPROM_Counter counter;
+extern State_controller state_controller;
+extern Input_trace input_trace;
+
+const int eeprom_cycle_duration = 2; // enum counter in main_controllino_plc.cpp
+const int eeprom_max_temperature = 3;
+
+// SIMULATION STATE ************************************************************
+
+Virtual_rig rig;
+bool verbose = false;
+long cycles_completed = 0;
+long error_stops = 0;
+long timeouts = 0;
+long timeout_resets = 0;
+FILE *trace_file = 0;
+std::vector<double> forces; // [N]
+struct Force_profile_record {
+  long peak, time_to_peak, rise_time, plateau_mean, samples, stored_samples; // features sent by the firmware
+  long curve_samples, curve_value, curve_peak; // rebuilt from the delta compressed curve
+};
+std::vector<Force_profile_record> force_profiles;
+unsigned long long last_cycle_micros = 0;
+std::vector<unsigned long long> cycle_times; // [us]
+std::vector<double> step_time_sums; // [ms]
+long step_time_records = 0;
+
+// SERIAL OUTPUT OF THE FIRMWARE ***********************************************
+
+// <index of the first step>;<duration>,<duration>,...;
+void parse_step_times(const std::string &values) {
+  size_t index = atoi(values.c_str());
+  size_t start = values.find(';') + 1;
+  if (index == 0) {
+    step_time_records++;
+  }
+  while (start > 0 && start < values.size()) {
+    size_t end = values.find_first_of(",;", start);
+    if (end == std::string::npos) {
+      end = values.size();
+    }
+    if (step_time_sums.size() <= index) {
+      step_time_sums.resize(index + 1);
+    }
+    step_time_sums[index++] += atof(values.substr(start, end - start).c_str());
+    start = end + 1;
+  }
+}
+
+void parse_force_profile(const std::string &values) {
+  Force_profile_record record = {};
+  sscanf(values.c_str(), "%ld;%ld;%ld;%ld;%ld;%ld", &record.peak, &record.time_to_peak, &record.rise_time,
+         &record.plateau_mean, &record.samples, &record.stored_samples);
+  force_profiles.push_back(record);
+}
+
+void parse_force_curve(const std::string &values) {
+  if (force_profiles.empty()) {
+    return;
+  }
+  Force_profile_record &record = force_profiles.back();
+  const char *text = values.c_str();
+  char *end;
+  strtol(text, &end, 10); // index of the first sample
+  while (*end == ';' || *end == ',') {
+    text = end + 1;
+    long delta = strtol(text, &end, 10);
+    if (end == text) {
+      break;
+    }
+    record.curve_value += delta;
+    record.curve_peak = record.curve_samples ? max(record.curve_peak, record.curve_value) : record.curve_value;
+    record.curve_samples++;
+  }
+}
+
+void handle_log_line(HardwareSerial &port, const std::string &line) {
+  if (line.compare(0, 7, "TRACES;") == 0) {
+    if (trace_file) {
+      fprintf(trace_file, "%s\n", line.c_str());
+    }
+    return;
+  }
+  if (verbose) {
+    printf("[%10.3f] %s: %s\n", virtual_micros() / 1e6, port.name, line.c_str());
+  }
+  if (line.compare(0, 18, "LOG;FORCE_TENSION;") == 0) {
+    forces.push_back(atof(line.substr(18).c_str()));
+  }
+  if (line.compare(0, 15, "LOG;CYCLE_TOTAL") == 0) {
+    if (last_cycle_micros) {
+      cycle_times.push_back(virtual_micros() - last_cycle_micros);
+    }
+    last_cycle_micros = virtual_micros();
+    cycles_completed++;
+  }
+  if (line.compare(0, 18, "LOG;FORCE_PROFILE;") == 0) {
+    parse_force_profile(line.substr(18));
+  }
+  if (line.compare(0, 16, "LOG;FORCE_CURVE;") == 0) {
+    parse_force_curve(line.substr(16));
+  }
+  if (line.compare(0, 15, "LOG;STEP_TIMES;") == 0) {
+    parse_step_times(line.substr(15));
+  }
+  if (line.compare(0, 21, "EMAIL;MACHINE_STOPPED") == 0) {
+    error_stops++;
+  }
+}
+
+// Virtual panel: reports page changes like the real display does.
+// Commands sent with a baud rate other than the one of the panel are lost.
+unsigned long panel_baud_rate = 9600;
+unsigned long panel_max_baud_rate = 115200;
+uint8_t panel_page = 0;
+const unsigned long panel_processing_micros = 1000;
+long waveform_points = 0;
+long waveform_clears = 0;
+
+void handle_nextion_command(HardwareSerial &port, const std::string &command) {
+  if (port.baud != panel_baud_rate) {
+    return;
+  }
+  if (verbose) {
+    printf("[%10.3f] %s: %s\n", virtual_micros() / 1e6, port.name, command.c_str());
+  }
+  if (command == "rest") {
+    panel_baud_rate = 9600;
+  }
+  if (command.compare(0, 5, "baud=") == 0) {
+    unsigned long baud_rate = atol(command.substr(5).c_str());
+    if (baud_rate <= panel_max_baud_rate) {
+      panel_baud_rate = baud_rate;
+    }
+  }
+  if (command == "sendme") {
+    // Answer after the rest of the terminator and the processing time:
+    unsigned long long delay_micros = 2 * 10000000ULL / port.baud + panel_processing_micros;
+    uint8_t answer[] = {0x66, panel_page, 0xFF, 0xFF, 0xFF};
+    port.inject_rx(answer, sizeof(answer), delay_micros);
+  }
+  if (command == "page 0") {
+    panel_page = 0;
+    inject_nextion_touch(0, 0, true);
+  }
+  if (command == "page 1") {
+    panel_page = 1;
+    inject_nextion_touch(1, 0, true);
+  }
+  if (command.compare(0, 4, "add ") == 0) {
+    waveform_points++;
+  }
+  if (command.compare(0, 4, "cle ") == 0) {
+    waveform_clears++;
+  }
+  if (command.find("\"STOPPED ...\"") != std::string::npos) {
+    timeouts++;
+  }
+  if (command.find("\"RESET ") != std::string::npos) {
+    timeout_resets++;
+  }
+}
+
+// OPERATOR ********************************************************************
+// Switches to auto mode and starts the rig whenever it has stopped.
+// After an error stop, the reset button is pushed first.
+
+void operate_rig() {
+  static unsigned long long next_action_micros = 0;
+  if (virtual_micros() < next_action_micros) {
+    return;
+  }
+  next_action_micros = virtual_micros() + 1000000;
+
+  if (!state_controller.electrocylinder_is_ready() || state_controller.reset_mode_is_active()) {
+    return;
+  }
+  if (state_controller.is_in_error_mode()) {
+    inject_nextion_touch(1, 5, true); // reset
+    return;
+  }
+  if (state_controller.is_in_step_mode()) {
+    inject_nextion_touch(1, 4, true); // step/auto switch
+  }
+  if (!state_controller.machine_is_running()) {
+    inject_nextion_touch(1, 3, true); // play/pause switch
+  }
+}
+
+// REPORT **********************************************************************
+
+void print_report(double wall_seconds, unsigned long long max_scan_micros, unsigned long long scans) {
+  printf("-----------------------------------------------------------\n");
+  printf("SIMULATION RESULT\n");
+  printf("cycles completed:        %ld\n", cycles_completed);
+  printf("simulated time:          %.1f s\n", virtual_micros() / 1e6);
+  printf("wall clock time:         %.2f s (%.0f cycles/s)\n", wall_seconds,
+         wall_seconds > 0 ? cycles_completed / wall_seconds : 0);
+
+  if (!cycle_times.empty()) {
+    unsigned long long min_time = cycle_times[0];
+    unsigned long long max_time = cycle_times[0];
+    unsigned long long sum = 0;
+    for (size_t i = 0; i < cycle_times.size(); i++) {
+      min_time = min(min_time, cycle_times[i]);
+      max_time = max(max_time, cycle_times[i]);
+      sum += cycle_times[i];
+    }
+    printf("cycle time [ms]:         min %.1f / mean %.1f / max %.1f\n", min_time / 1e3,
+           sum / 1e3 / cycle_times.size(), max_time / 1e3);
+  }
+  printf("scan time [us]:          mean %.0f / max %llu\n", scans ? virtual_micros() / double(scans) : 0,
+         max_scan_micros);
+  printf("display bytes sent:      %llu (blocked %.1f ms)\n", Serial2.bytes_sent, Serial2.blocked_micros / 1e3);
+  printf("waveform points:         %ld (%ld curves cleared)\n", waveform_points, waveform_clears);
+  printf("log bytes sent:          %llu (blocked %.1f ms)\n", Serial1.bytes_sent, Serial1.blocked_micros / 1e3);
+  printf("heap allocations:        %llu (in loop() after the first cycle)\n", get_heap_allocations());
+  printf("timeouts:                %ld\n", timeouts);
+  printf("timeout resets:          %ld\n", timeout_resets);
+  printf("error stops:             %ld\n", error_stops);
+
+  if (!forces.empty()) {
+    double min_force = forces[0];
+    double max_force = forces[0];
+    double sum = 0;
+    for (size_t i = 0; i < forces.size(); i++) {
+      min_force = min(min_force, forces[i]);
+      max_force = max(max_force, forces[i]);
+      sum += forces[i];
+    }
+    printf("forces logged [N]:       %zu (min %.0f / mean %.0f / max %.0f)\n", forces.size(), min_force,
+           sum / forces.size(), max_force);
+  }
+
+  if (!force_profiles.empty()) {
+    double peak = 0, time_to_peak = 0, rise_time = 0, plateau_mean = 0;
+    size_t complete_curves = 0;
+    for (size_t i = 0; i < force_profiles.size(); i++) {
+      const Force_profile_record &record = force_profiles[i];
+      peak += record.peak;
+      time_to_peak += record.time_to_peak;
+      rise_time += record.rise_time;
+      plateau_mean += record.plateau_mean;
+      if (record.curve_samples == record.stored_samples && record.curve_peak == record.peak) {
+        complete_curves++;
+      }
+    }
+    double n = force_profiles.size();
+    printf("force profiles:          %zu (%zu curves complete)\n", force_profiles.size(), complete_curves);
+    printf("  mean peak %.0f N / time to peak %.0f ms / rise time %.0f ms / plateau %.0f N\n", peak / n,
+           time_to_peak / n, rise_time / n, plateau_mean / n);
+  }
+
+  if (step_time_records) {
+    printf("mean step durations [ms]:\n");
+    for (size_t i = 0; i < step_time_sums.size(); i++) {
+      printf("  step %2zu: %8.1f\n", i + 1, step_time_sums[i] / step_time_records);
+    }
+  }
+  printf("-----------------------------------------------------------\n");
+}
+
+// MAIN ************************************************************************
+
+int main(int argc, char *argv[]) {
+  long cycles_to_run = 1000;
+  unsigned long scan_micros = 250;
+  long pause_seconds = 0;
+  long stall_feed_at_cycle = -1;
+  const char *replay_file_path = 0;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--cycles" && has_value) {
+      cycles_to_run = atol(argv[++i]);
+    } else if (arg == "--scan-us" && has_value) {
+      scan_micros = atol(argv[++i]);
+    } else if (arg == "--pause-s" && has_value) {
+      pause_seconds = atol(argv[++i]);
+    } else if (arg == "--stall-feed-at-cycle" && has_value) {
+      stall_feed_at_cycle = atol(argv[++i]);
+    } else if (arg == "--panel-max-baud" && has_value) {
+      panel_max_baud_rate = atol(argv[++i]);
+    } else if (arg == "--record-trace" && has_value) {
+      trace_file = fopen(argv[++i], "w");
+      if (!trace_file) {
+        printf("cannot write trace file: %s\n", argv[i]);
+        return 2;
+      }
+    } else if (arg == "--replay-trace" && has_value) {
+      replay_file_path = argv[++i];
+    } else if (arg == "--verbose") {
+      verbose = true;
+    } else if (arg == "--benchmark-conversions") {
+      return run_conversion_benchmark() ? 0 : 1;
+    } else if (arg == "--benchmark-peak-tracker") {
+      return run_peak_tracker_benchmark() ? 0 : 1;
+    } else {
+      printf("unknown option: %s\n", arg.c_str());
+      return 2;
+    }
+  }
+
+  Serial.line_handler = handle_log_line;
+  Serial1.line_handler = handle_log_line;
+  Serial2.line_handler = handle_nextion_command;
+
+  auto wall_start = std::chrono::steady_clock::now();
+  setup();
+  counter.set_value(eeprom_cycle_duration, pause_seconds);
+  counter.set_value(eeprom_max_temperature, 150);
+
+  Trace_player trace_player(input_trace);
+  if (replay_file_path) {
+    if (!trace_player.load(replay_file_path)) {
+      printf("no trace found in file: %s\n", replay_file_path);
+      return 2;
+    }
+    printf("replaying %lu trace samples from %s\n", trace_player.get_no_of_samples(), replay_file_path);
+    trace_player.start();
+  }
+
+  unsigned long long max_scan_micros = 0;
+  unsigned long long scans = 0;
+  unsigned long long stall_end_micros = 0;
+  unsigned long long time_limit = (unsigned long long)cycles_to_run * (pause_seconds + 60) * 1000000ULL;
+
+  while (replay_file_path ? !trace_player.is_finished()
+                          : cycles_completed < cycles_to_run && virtual_micros() < time_limit) {
+    operate_rig();
+    if (replay_file_path) {
+      trace_player.update();
+    }
+
+    if (cycles_completed == stall_feed_at_cycle && !stall_end_micros) {
+      rig.set_feed_stalled(true);
+      stall_end_micros = virtual_micros() + 30000000ULL;
+    }
+    if (stall_end_micros && virtual_micros() > stall_end_micros) {
+      rig.set_feed_stalled(false);
+    }
+
+    unsigned long long scan_start = virtual_micros();
+    advance_virtual_time(scan_micros);
+    set_heap_counting(cycles_completed > 0);
+    loop();
+    set_heap_counting(false);
+    unsigned long long scan_time = virtual_micros() - scan_start;
+    max_scan_micros = max(max_scan_micros, scan_time);
+    scans++;
+    if (!replay_file_path) {
+      rig.update(scan_time);
+    }
+  }
+  if (trace_file) {
+    fclose(trace_file);
+  }
+
+  double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+  print_report(wall_seconds, max_scan_micros, scans);
+  if (replay_file_path) {
+    return error_stops ? 1 : 0;
+  }
+  return cycles_completed >= cycles_to_run ? 0 : 1;
+}
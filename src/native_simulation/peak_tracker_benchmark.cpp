@@ -0,0 +1,225 @@
+/*******************************************************************************
+ * peak_tracker_benchmark.cpp **************************************************
+ *******************************************************************************/
+
+#include "peak_tracker_benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <common/peak_tracker.h>
+#include <common/sensor_conversion.h>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+Sensor_conversion clamp_conversion(make_fixed_point_scale(100.0 * 100 / 1024, 1023), 2048 + 64);
+
+const long cycle_start_threshold = 3500; // [0.01A]
+const long cycle_stop_threshold = 500; // [0.01A]
+const byte peak_count = 5;
+
+// MODEL OF THE REPLACED RUNNINGMEDIAN LIBRARY *********************************
+// Ring buffer of the last values, sorted by insertion sort when queried after
+// an add().
+
+class Running_median_reference {
+public:
+  Running_median_reference(byte size) : _size(size) { clear(); }
+
+  void add(float value) {
+    _values[_index] = value;
+    _index = (_index + 1) % _size;
+    _count = min(byte(_count + 1), _size);
+    _is_sorted = false;
+  }
+
+  void clear() {
+    _index = 0;
+    _count = 0;
+    _is_sorted = false;
+  }
+
+  float get_lowest() {
+    if (!_count) {
+      return NAN;
+    }
+    sort();
+    return _values[_order[0]];
+  }
+
+  float get_median() {
+    if (!_count) {
+      return NAN;
+    }
+    sort();
+    if (_count & 1) {
+      return _values[_order[_count / 2]];
+    }
+    return (_values[_order[_count / 2 - 1]] + _values[_order[_count / 2]]) / 2;
+  }
+
+  byte get_count() { return _count; }
+
+private:
+  byte _size;
+  float _values[20];
+  byte _order[20];
+  byte _index;
+  byte _count;
+  bool _is_sorted;
+
+  void sort() {
+    if (_is_sorted) {
+      return;
+    }
+    for (byte i = 0; i < _count; i++) {
+      _order[i] = i;
+    }
+    for (byte i = 1; i < _count; i++) {
+      byte index = _order[i];
+      byte j = i;
+      while (j > 0 && _values[_order[j - 1]] > _values[index]) {
+        _order[j] = _order[j - 1];
+        j--;
+      }
+      _order[j] = index;
+    }
+    _is_sorted = true;
+  }
+};
+
+// SIGNAL **********************************************************************
+
+std::vector<int> create_clamp_signal() {
+  const long sample_rate = 4000; // [Hz]
+  std::vector<int> signal;
+  unsigned long random = 12345;
+  auto noise = [&random](int amplitude) {
+    random = random * 1103515245 + 12345;
+    return int((random >> 16) % (2 * amplitude + 1)) - amplitude;
+  };
+  for (int cycle = 0; cycle < 20; cycle++) {
+    int peak = 450 + 10 * (cycle % 7); // [adc]
+    for (long i = 0; i < sample_rate; i++) { // stroke: ramp, plateau
+      int value = i < sample_rate / 4 ? peak * i / (sample_rate / 4) : peak;
+      if (noise(1000) == 0) {
+        value += 200; // spike
+      }
+      signal.push_back(min(1023, max(0, value + noise(15))));
+    }
+    for (long i = 0; i < sample_rate / 2; i++) { // idle, logs the cycle
+      signal.push_back(max(0, 20 + noise(10)));
+    }
+  }
+  return signal;
+}
+
+// PEAK DETECTION **************************************************************
+
+struct Detection_result {
+  std::vector<long> logged_currents; // [0.01A]
+  double samples_per_second;
+};
+
+Detection_result run_detection(const std::vector<int> &signal, const std::function<void(int)> &add_sample,
+                               std::vector<long> &logged_currents) {
+  const int repetitions = 50;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repetitions; i++) {
+    logged_currents.clear();
+    for (size_t sample = 0; sample < signal.size(); sample++) {
+      add_sample(signal[sample]);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+  return Detection_result{logged_currents, double(repetitions) * signal.size() / seconds};
+}
+
+Detection_result detect_with_running_median(const std::vector<int> &signal) {
+  Running_median_reference median(20);
+  bool is_over_threshold = false;
+  std::vector<long> logged_currents;
+  return run_detection(
+      signal,
+      [&](int adc_value) {
+        long current = clamp_conversion.convert(adc_value);
+        is_over_threshold = current > cycle_start_threshold || (is_over_threshold && current >= cycle_stop_threshold);
+        if (is_over_threshold) {
+          if (std::isnan(median.get_lowest())) {
+            median.add(current);
+          } else if (current > median.get_lowest()) {
+            median.add(current);
+          }
+        } else if (median.get_count() > 0) {
+          logged_currents.push_back(long(median.get_median()));
+          median.clear();
+        }
+      },
+      logged_currents);
+}
+
+Detection_result detect_with_peak_tracker(const std::vector<int> &signal) {
+  Peak_tracker peaks(peak_count);
+  const int start_adc_value = clamp_conversion.get_adc_value(cycle_start_threshold + 1);
+  const int stop_adc_value = clamp_conversion.get_adc_value(cycle_stop_threshold);
+  bool is_over_threshold = false;
+  std::vector<long> logged_currents;
+  return run_detection(
+      signal,
+      [&](int adc_value) {
+        is_over_threshold = adc_value >= start_adc_value || (is_over_threshold && adc_value >= stop_adc_value);
+        if (is_over_threshold) {
+          peaks.add(adc_value);
+        } else if (peaks.get_count() > 0) {
+          logged_currents.push_back(clamp_conversion.convert(peaks.get_lowest()));
+          peaks.clear();
+        }
+      },
+      logged_currents);
+}
+
+// Smallest of the biggest values of every cycle, by a full sort:
+std::vector<long> expected_currents(const std::vector<int> &signal) {
+  std::vector<long> currents;
+  std::vector<int> cycle_values;
+  bool is_over_threshold = false;
+  for (size_t sample = 0; sample < signal.size(); sample++) {
+    long current = clamp_conversion.convert(signal[sample]);
+    is_over_threshold = current > cycle_start_threshold || (is_over_threshold && current >= cycle_stop_threshold);
+    if (is_over_threshold) {
+      cycle_values.push_back(signal[sample]);
+    } else if (!cycle_values.empty()) {
+      std::sort(cycle_values.begin(), cycle_values.end(), std::greater<int>());
+      size_t index = min(cycle_values.size(), size_t(peak_count)) - 1;
+      currents.push_back(clamp_conversion.convert(cycle_values[index]));
+      cycle_values.clear();
+    }
+  }
+  return currents;
+}
+
+double get_mean(const std::vector<long> &values) {
+  double sum = 0;
+  for (size_t i = 0; i < values.size(); i++) {
+    sum += values[i];
+  }
+  return values.empty() ? 0 : sum / values.size() / 100;
+}
+
+bool run_peak_tracker_benchmark() {
+  std::vector<int> signal = create_clamp_signal();
+  Detection_result before = detect_with_running_median(signal);
+  Detection_result after = detect_with_peak_tracker(signal);
+  bool is_ok = after.logged_currents == expected_currents(signal);
+
+  printf("-----------------------------------------------------------\n");
+  printf("CURRENT PEAK DETECTION (%zu SAMPLES)\n", signal.size());
+  printf("RunningMedian(20) float   %6.1f M samples/s   %zu cycles, mean %.2f A\n", before.samples_per_second / 1e6,
+         before.logged_currents.size(), get_mean(before.logged_currents));
+  printf("Peak_tracker (top %d) adc  %6.1f M samples/s   %zu cycles, mean %.2f A\n", peak_count,
+         after.samples_per_second / 1e6, after.logged_currents.size(), get_mean(after.logged_currents));
+  printf("logged peaks match a full sort: %s\n", is_ok ? "ok" : "FAILED");
+  printf("-----------------------------------------------------------\n");
+  return is_ok;
+}
@@ -0,0 +1,22 @@
+/* *****************************************************************************
+ * peak_tracker_benchmark.h ****************************************************
+ * *****************************************************************************
+ * Runs the peak detection of the current logger over a synthetic clamp
+ * signal (tool cycles with noise and spikes, sampled at 4000Hz):
+ * - before: float centiamps of every sample in a RunningMedian(20), queried
+ *   with getLowest() for every sample (model of the replaced library)
+ * - after: raw ADC values in the Peak_tracker, converted when logged
+ * Prints the samples per second of both and checks the logged peaks of the
+ * Peak_tracker against a full sort of every tool cycle.
+ *
+ * The host has an FPU, on the AVR the float conversion and comparisons are
+ * emulated in software and the difference is much bigger.
+ * *****************************************************************************
+ */
+
+#ifndef PEAKTRACKERBENCHMARK_H
+#define PEAKTRACKERBENCHMARK_H
+
+bool run_peak_tracker_benchmark(); // true if the logged peaks are correct
+
+#endif
@@ -0,0 +1,155 @@
+/* *****************************************************************************
+ * Arduino.h (native simulation shim) ******************************************
+ * *****************************************************************************
+ * Replaces the Arduino core when the PLC firmware is compiled for the host.
+ * Time, pins and serial ports are provided by virtual_hardware.cpp.
+ * *****************************************************************************
+ */
+
+#ifndef ARDUINO_SHIM_H
+#define ARDUINO_SHIM_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <utility>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+class __FlashStringHelper;
+
+inline uint8_t pgm_read_byte(const void *address) { return *static_cast<const uint8_t *>(address); }
+inline uint16_t pgm_read_word(const void *address) { return *static_cast<const uint16_t *>(address); }
+inline uint32_t pgm_read_dword(const void *address) { return *static_cast<const uint32_t *>(address); }
+inline const void *pgm_read_ptr(const void *address) { return *static_cast<const void *const *>(address); }
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define memcpy_P memcpy
+
+using std::isnan;
+using std::max;
+using std::min;
+
+// TIME AND PINS ---------------------------------------------------------------
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+// STRING ----------------------------------------------------------------------
+class String {
+public:
+  String() {}
+  String(const char *text) : _text(text ? text : "") {}
+  String(const std::string &text) : _text(text) {}
+  String(char c) : _text(1, c) {}
+  String(int value) : _text(std::to_string(value)) {}
+  String(unsigned int value) : _text(std::to_string(value)) {}
+  String(long value) : _text(std::to_string(value)) {}
+  String(unsigned long value) : _text(std::to_string(value)) {}
+  String(float value, unsigned char decimals = 2);
+  String(double value, unsigned char decimals = 2);
+
+  const char *c_str() const { return _text.c_str(); }
+  unsigned int length() const { return _text.size(); }
+  String &operator+=(const String &other) {
+    _text += other._text;
+    return *this;
+  }
+  friend String operator+(const String &a, const String &b) { return String(a._text + b._text); }
+  bool operator==(const String &other) const { return _text == other._text; }
+  bool operator!=(const String &other) const { return _text != other._text; }
+
+private:
+  std::string _text;
+};
+
+// PRINT -----------------------------------------------------------------------
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *text) { return print(text); }
+  size_t print(const char *text);
+  size_t print(const __FlashStringHelper *text) { return print(reinterpret_cast<const char *>(text)); }
+  size_t print(const String &text) { return print(text.c_str()); }
+  size_t print(char c) { return write(uint8_t(c)); }
+  size_t print(int value) { return print(long(value)); }
+  size_t print(unsigned int value) { return print((unsigned long)value); }
+  size_t print(long value) { return print(String(value)); }
+  size_t print(unsigned long value) { return print(String(value)); }
+  size_t print(double value, int decimals = 2) { return print(String(value, decimals)); }
+  size_t println() { return print("\r\n"); }
+  template <typename T> size_t println(T value) { return print(value) + println(); }
+  size_t println(double value, int decimals) { return print(value, decimals) + println(); }
+};
+
+// HARDWARE SERIAL -------------------------------------------------------------
+// Sending takes virtual time according to the baud rate. A full 64 byte
+// TX buffer blocks (advances the virtual clock) like on the real hardware.
+class HardwareSerial : public Print {
+public:
+  HardwareSerial(const char *name);
+  void begin(unsigned long baud);
+  void end() {}
+  int available();
+  int read();
+  int peek();
+  int availableForWrite();
+  void flush();
+  size_t write(uint8_t c);
+  using Print::write;
+  operator bool() { return true; }
+
+  // SIMULATION INTERFACE:
+  const char *name;
+  unsigned long baud;
+  void (*line_handler)(HardwareSerial &port, const std::string &line);
+  void inject_rx(const uint8_t *data, size_t size, unsigned long long delay_micros = 0);
+  unsigned long long bytes_sent;
+  unsigned long long blocked_micros;
+
+private:
+  std::deque<std::pair<unsigned long long, uint8_t> > _rx_buffer; // arrival time, byte
+  std::string _tx_line;
+  unsigned long long _tx_busy_until;
+  unsigned int bytes_in_tx_buffer();
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+
+#endif
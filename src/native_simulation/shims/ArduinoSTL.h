@@ -0,0 +1,3 @@
+// ArduinoSTL.h (native simulation shim): the host has a full STL
+#include <Arduino.h>
+#include <vector>
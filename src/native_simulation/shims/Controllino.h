@@ -0,0 +1,2 @@
+// Controllino.h (native simulation shim): pin aliases come from alias_colino.h
+#include <Arduino.h>
@@ -0,0 +1,59 @@
+/* *****************************************************************************
+ * Cylinder.h (native simulation shim) *****************************************
+ * *****************************************************************************
+ * Same interface as https://github.com/chischte/cylinder-library
+ * *****************************************************************************
+ */
+
+#ifndef CYLINDER_H
+#define CYLINDER_H
+
+#include <Arduino.h>
+
+class Cylinder {
+public:
+  Cylinder(int pin) {
+    _pin = pin;
+    pinMode(pin, OUTPUT);
+  }
+  void set(bool state) {
+    _state = state;
+    digitalWrite(_pin, state);
+  }
+  void toggle() { set(!_state); }
+  bool get_state() { return _state; }
+
+  // Non blocking stroke, has to be called until the stroke is completed:
+  void stroke(unsigned long push_time, unsigned long release_time) {
+    if (!_stroke_is_active) {
+      _stroke_is_active = true;
+      _stroke_start_millis = millis();
+      set(1);
+    }
+    if (_state && millis() - _stroke_start_millis >= push_time) {
+      set(0);
+      _stroke_start_millis = millis();
+    }
+    if (!_state && millis() - _stroke_start_millis >= release_time) {
+      _stroke_is_active = false;
+      _stroke_completed = true;
+    }
+  }
+  bool stroke_completed() {
+    bool stroke_completed = _stroke_completed;
+    _stroke_completed = false;
+    return stroke_completed;
+  }
+  void abort_stroke() {
+    _stroke_is_active = false;
+    _stroke_completed = false;
+  }
+
+private:
+  int _pin;
+  bool _state = false;
+  bool _stroke_is_active = false;
+  bool _stroke_completed = false;
+  unsigned long _stroke_start_millis = 0;
+};
+#endif
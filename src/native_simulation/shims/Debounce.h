@@ -0,0 +1,41 @@
+/* *****************************************************************************
+ * Debounce.h (native simulation shim) *****************************************
+ * *****************************************************************************
+ * Same interface as https://github.com/chischte/debounce-library
+ * The virtual inputs do not bounce, so the states are not debounced.
+ * *****************************************************************************
+ */
+
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <Arduino.h>
+
+class Debounce {
+public:
+  Debounce(int pin) {
+    _pin = pin;
+    pinMode(pin, INPUT);
+  }
+  bool get_raw_button_state() { return digitalRead(_pin); }
+  bool get_button_state() { return digitalRead(_pin); }
+  bool switched_high() {
+    bool state = digitalRead(_pin);
+    bool has_switched = state && !_previous_state_high;
+    _previous_state_high = state;
+    return has_switched;
+  }
+  bool switched_low() {
+    bool state = digitalRead(_pin);
+    bool has_switched = !state && _previous_state_low;
+    _previous_state_low = state;
+    return has_switched;
+  }
+  void set_debounce_time(unsigned long debounce_time) {}
+
+private:
+  int _pin;
+  bool _previous_state_high = false;
+  bool _previous_state_low = false;
+};
+#endif
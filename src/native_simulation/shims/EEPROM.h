@@ -0,0 +1,33 @@
+/* *****************************************************************************
+ * EEPROM.h (native simulation shim) *******************************************
+ * *****************************************************************************
+ * Same interface as the EEPROM library of the Arduino AVR core (read/update).
+ * The 4kB of the ATmega2560 are kept in RAM, erased to 0xFF at startup.
+ * *****************************************************************************
+ */
+
+#ifndef EEPROM_SHIM_H
+#define EEPROM_SHIM_H
+
+#include <Arduino.h>
+
+#define EEPROM_SHIM_SIZE 4096
+
+class EEPROMClass {
+public:
+  EEPROMClass() { memset(_data, 0xFF, sizeof(_data)); }
+  uint8_t read(int address) { return address >= 0 && address < EEPROM_SHIM_SIZE ? _data[address] : 0xFF; }
+  void write(int address, uint8_t value) {
+    if (address >= 0 && address < EEPROM_SHIM_SIZE) {
+      _data[address] = value;
+    }
+  }
+  void update(int address, uint8_t value) { write(address, value); }
+  uint16_t length() { return EEPROM_SHIM_SIZE; }
+
+private:
+  uint8_t _data[EEPROM_SHIM_SIZE];
+};
+
+static EEPROMClass EEPROM;
+#endif
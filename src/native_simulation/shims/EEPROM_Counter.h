@@ -0,0 +1,24 @@
+/* *****************************************************************************
+ * EEPROM_Counter.h (native simulation shim) ***********************************
+ * *****************************************************************************
+ * Same interface as https://github.com/chischte/eeprom-counter-library
+ * The values are kept in RAM.
+ * *****************************************************************************
+ */
+
+#ifndef EEPROM_COUNTER_H
+#define EEPROM_COUNTER_H
+
+#define EEPROM_COUNTER_MAX_VALUES 32
+
+class EEPROM_Counter {
+public:
+  void setup(int eeprom_min_address, int eeprom_max_address, int number_of_values) {}
+  long get_value(int value_number) { return _values[value_number]; }
+  void set_value(int value_number, long value) { _values[value_number] = value; }
+  void count_one_up(int value_number) { _values[value_number]++; }
+
+private:
+  long _values[EEPROM_COUNTER_MAX_VALUES] = {0};
+};
+#endif
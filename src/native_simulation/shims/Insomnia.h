@@ -0,0 +1,57 @@
+/* *****************************************************************************
+ * Insomnia.h (native simulation shim) *****************************************
+ * *****************************************************************************
+ * Same interface as https://github.com/chischte/insomnia-delay-library
+ * *****************************************************************************
+ */
+
+#ifndef INSOMNIA_H
+#define INSOMNIA_H
+
+#include <Arduino.h>
+
+class Insomnia {
+public:
+  Insomnia(unsigned long timeout_time = 0) {
+    _timeout_time = timeout_time;
+    _previous_millis = millis();
+  }
+
+  // TIMEOUT:
+  bool has_timed_out() { return millis() - _previous_millis > _timeout_time; }
+  void reset_time() { _previous_millis = millis(); }
+  void set_time(unsigned long timeout_time) { _timeout_time = timeout_time; }
+  void set_flag_activated(bool flag_state) { _flag_activated = flag_state; }
+  bool is_marked_activated() { return _flag_activated; }
+
+  // DELAY:
+  bool delay_time_is_up(unsigned long delay_time) {
+    _delay_time = delay_time;
+    if (!_delay_is_active) {
+      _delay_is_active = true;
+      _delay_start_millis = millis();
+    }
+    if (millis() - _delay_start_millis >= delay_time) {
+      _delay_is_active = false;
+      return true;
+    }
+    return false;
+  }
+  void set_unstarted() { _delay_is_active = false; }
+  unsigned long get_remaining_delay_time() {
+    if (!_delay_is_active) {
+      return _delay_time;
+    }
+    unsigned long time_elapsed = millis() - _delay_start_millis;
+    return time_elapsed >= _delay_time ? 0 : _delay_time - time_elapsed;
+  }
+
+private:
+  unsigned long _timeout_time;
+  unsigned long _previous_millis;
+  unsigned long _delay_start_millis = 0;
+  unsigned long _delay_time = 0;
+  bool _delay_is_active = false;
+  bool _flag_activated = false;
+};
+#endif
@@ -0,0 +1,59 @@
+/* *****************************************************************************
+ * Nextion.h (native simulation shim) ******************************************
+ * *****************************************************************************
+ * Same interface as the ITEAD Nextion library, as far as the firmware uses it.
+ * Touch events are injected by the simulation, see virtual_hardware.h
+ * *****************************************************************************
+ */
+
+#ifndef NEXTION_H
+#define NEXTION_H
+
+#include <Arduino.h>
+
+#define NEX_EVENT_PUSH 0x01
+#define NEX_EVENT_POP 0x00
+
+typedef void (*NexTouchEventCb)(void *ptr);
+
+class NexTouch {
+public:
+  NexTouch(uint8_t pid, uint8_t cid, const char *name);
+  void attachPush(NexTouchEventCb push, void *ptr = 0);
+  void attachPop(NexTouchEventCb pop, void *ptr = 0);
+  uint8_t getObjPid() { return _pid; }
+  uint8_t getObjCid() { return _cid; }
+  const char *getObjName() { return _name; }
+  static void iterate(NexTouch **list, uint8_t pid, uint8_t cid, int32_t event);
+
+private:
+  uint8_t _pid;
+  uint8_t _cid;
+  const char *_name;
+  NexTouchEventCb _push;
+  void *_push_ptr;
+  NexTouchEventCb _pop;
+  void *_pop_ptr;
+};
+
+class NexPage : public NexTouch {
+public:
+  NexPage(uint8_t pid, uint8_t cid, const char *name) : NexTouch(pid, cid, name) {}
+};
+
+class NexButton : public NexTouch {
+public:
+  NexButton(uint8_t pid, uint8_t cid, const char *name) : NexTouch(pid, cid, name) {}
+};
+
+class NexDSButton : public NexTouch {
+public:
+  NexDSButton(uint8_t pid, uint8_t cid, const char *name) : NexTouch(pid, cid, name) {}
+};
+
+bool nexInit();
+void nexLoop(NexTouch *nex_listen_list[]);
+void sendCommand(const char *cmd);
+bool recvRetCommandFinished(uint32_t timeout = 100);
+
+#endif
@@ -0,0 +1 @@
+// SD.h (native simulation shim): the SD card is not used by the firmware
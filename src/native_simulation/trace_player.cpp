@@ -0,0 +1,118 @@
+/*******************************************************************************
+ * trace_player.cpp ************************************************************
+ *******************************************************************************/
+
+#include "trace_player.h"
+#include "virtual_hardware.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Trace_player::Trace_player(const Input_trace &input_trace) : _input_trace(input_trace) {
+  _next_sample = 0;
+  _time_offset = 0;
+}
+
+// LOAD ------------------------------------------------------------------------
+bool Trace_player::load(const char *file_path) {
+  FILE *file = fopen(file_path, "r");
+  if (!file) {
+    return false;
+  }
+  _samples.clear();
+  char line[256];
+  while (fgets(line, sizeof(line), file)) {
+    if (!parse_batch_line(line)) {
+      Trace_sample sample;
+      if (parse_line(line, sample)) {
+        _samples.push_back(sample);
+      }
+    }
+  }
+  fclose(file);
+  return !_samples.empty();
+}
+
+// TRACE;<millis>;<levels>;<analog 0>;<analog 1>;...
+bool Trace_player::parse_line(const char *line, Trace_sample &sample) {
+  const char *field = strstr(line, "TRACE;");
+  if (!field) {
+    return false;
+  }
+  char *end;
+  field += strlen("TRACE;");
+  sample.millis = strtoul(field, &end, 10);
+  if (end == field || *end != ';') {
+    return false;
+  }
+  return parse_values(end + 1, ';', sample);
+}
+
+// TRACES;<millis>;<dt>,<levels>,<analog 0>,<analog 1>;<dt>,<levels>,...;
+bool Trace_player::parse_batch_line(const char *line) {
+  const char *field = strstr(line, "TRACES;");
+  if (!field) {
+    return false;
+  }
+  char *end;
+  field += strlen("TRACES;");
+  unsigned long millis = strtoul(field, &end, 10);
+  if (end == field || *end != ';') {
+    return true; // a broken line, skipped
+  }
+  field = end + 1;
+  while (*field >= '0' && *field <= '9') {
+    Trace_sample sample;
+    sample.millis = millis + strtoul(field, &end, 10);
+    if (*end != ',' || !parse_values(end + 1, ',', sample)) {
+      return true;
+    }
+    millis = sample.millis;
+    _samples.push_back(sample);
+    field = strchr(field, ';') + 1;
+  }
+  return true;
+}
+
+// <levels><separator><analog 0><separator>...<analog n>;
+bool Trace_player::parse_values(const char *field, char separator, Trace_sample &sample) {
+  char *end;
+  sample.levels = strtoul(field, &end, 10);
+  for (byte i = 0; i < _input_trace.get_no_of_analog_pins(); i++) {
+    if (end == field || *end != separator) {
+      return false;
+    }
+    field = end + 1;
+    sample.analog_values[i] = strtol(field, &end, 10);
+  }
+  return end != field && *end == ';';
+}
+
+// REPLAY ----------------------------------------------------------------------
+void Trace_player::start() {
+  _next_sample = 0;
+  if (!_samples.empty()) {
+    _time_offset = long(_samples[0].millis) - long(millis());
+  }
+}
+
+void Trace_player::update() {
+  while (_next_sample < _samples.size() && long(_samples[_next_sample].millis) - _time_offset <= long(millis())) {
+    apply_sample(_samples[_next_sample++]);
+  }
+}
+
+void Trace_player::apply_sample(const Trace_sample &sample) {
+  for (byte i = 0; i < _input_trace.get_no_of_digital_pins(); i++) {
+    set_virtual_input(_input_trace.get_digital_pin(i), sample.levels & (1UL << i));
+  }
+  for (byte i = 0; i < _input_trace.get_no_of_analog_pins(); i++) {
+    set_virtual_analog_input(_input_trace.get_analog_pin(i), sample.analog_values[i]);
+  }
+}
+
+// GETTER ----------------------------------------------------------------------
+bool Trace_player::is_finished() { return _next_sample >= _samples.size(); }
+
+unsigned long Trace_player::get_no_of_samples() { return _samples.size(); }
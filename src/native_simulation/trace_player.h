@@ -0,0 +1,54 @@
+/* *****************************************************************************
+ * trace_player.h **************************************************************
+ * *****************************************************************************
+ * Replays an input trace recorded by Input_trace (controllino built with
+ * -D TRACE_INPUTS) into the virtual pins of the native simulation.
+ *
+ * Every sample of the TRACES lines (and of TRACE lines, the format before
+ * the samples were batched) is applied when the virtual clock reaches its
+ * timestamp, other lines are ignored, so raw captures of the log port can be
+ * replayed as they are. The first line is aligned to the start of the replay.
+ *
+ * The replay is open loop: the inputs follow the recorded timing, whatever
+ * the firmware does. If a change of the firmware makes the sequence faster
+ * or slower, the steps wait for the recorded sensor signals or time out.
+ * *****************************************************************************
+ */
+
+#ifndef TRACEPLAYER_H
+#define TRACEPLAYER_H
+
+#include <controllino_plc/input_trace.h>
+#include <vector>
+
+class Trace_player {
+
+public:
+  // FUNCTIONS:
+  Trace_player(const Input_trace &input_trace);
+
+  bool load(const char *file_path);
+  void start();
+  void update();
+  bool is_finished();
+  unsigned long get_no_of_samples();
+
+private:
+  // VARIABLES:
+  struct Trace_sample {
+    unsigned long millis;
+    unsigned long levels;
+    int analog_values[INPUT_TRACE_MAX_ANALOG_INPUTS];
+  };
+  const Input_trace &_input_trace;
+  std::vector<Trace_sample> _samples;
+  size_t _next_sample;
+  long _time_offset;
+
+  // FUNCTIONS:
+  bool parse_line(const char *line, Trace_sample &sample);
+  bool parse_batch_line(const char *line); // adds the samples, false if not a TRACES line
+  bool parse_values(const char *field, char separator, Trace_sample &sample);
+  void apply_sample(const Trace_sample &sample);
+};
+#endif
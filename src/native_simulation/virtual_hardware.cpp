@@ -0,0 +1,276 @@
+/*******************************************************************************
+ * virtual_hardware.cpp ********************************************************
+ *******************************************************************************/
+
+#include "virtual_hardware.h"
+#include <Nextion.h>
+#include <cstdio>
+#include <new>
+
+// CLOCK -----------------------------------------------------------------------
+static unsigned long long current_micros = 0;
+
+unsigned long long virtual_micros() { return current_micros; }
+void advance_virtual_time(unsigned long long micros_to_advance) { current_micros += micros_to_advance; }
+
+unsigned long millis() { return (unsigned long)(current_micros / 1000); }
+unsigned long micros() { return (unsigned long)current_micros; }
+void delay(unsigned long ms) { current_micros += (unsigned long long)ms * 1000; }
+void delayMicroseconds(unsigned int us) { current_micros += us; }
+
+// PINS ------------------------------------------------------------------------
+static int digital_levels[VIRTUAL_NO_OF_PINS];
+static int analog_values[VIRTUAL_NO_OF_PINS];
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin < VIRTUAL_NO_OF_PINS) {
+    digital_levels[pin] = value ? HIGH : LOW;
+  }
+}
+
+int digitalRead(uint8_t pin) { return pin < VIRTUAL_NO_OF_PINS ? digital_levels[pin] : LOW; }
+
+int analogRead(uint8_t pin) {
+  current_micros += 112; // conversion time of the AVR ADC
+  return pin < VIRTUAL_NO_OF_PINS ? analog_values[pin] : 0;
+}
+
+int get_virtual_output(uint8_t pin) { return digitalRead(pin); }
+
+void set_virtual_input(uint8_t pin, bool level) { digitalWrite(pin, level); }
+
+void set_virtual_analog_input(uint8_t pin, int adc_value) {
+  if (pin < VIRTUAL_NO_OF_PINS) {
+    analog_values[pin] = adc_value;
+  }
+}
+
+// HEAP ------------------------------------------------------------------------
+static bool heap_counting_enabled = false;
+static unsigned long long heap_allocations = 0;
+
+void set_heap_counting(bool enabled) { heap_counting_enabled = enabled; }
+unsigned long long get_heap_allocations() { return heap_allocations; }
+
+void *operator new(size_t size) {
+  if (heap_counting_enabled) {
+    heap_allocations++;
+  }
+  void *pointer = malloc(size ? size : 1);
+  if (!pointer) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void operator delete(void *pointer) noexcept { free(pointer); }
+void operator delete(void *pointer, size_t) noexcept { free(pointer); }
+
+// STRING ----------------------------------------------------------------------
+String::String(float value, unsigned char decimals) {
+  char buffer[40];
+  snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+  _text = buffer;
+}
+
+String::String(double value, unsigned char decimals) {
+  char buffer[40];
+  snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+  _text = buffer;
+}
+
+// PRINT -----------------------------------------------------------------------
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    write(buffer[i]);
+  }
+  return size;
+}
+
+size_t Print::print(const char *text) {
+  size_t size = 0;
+  while (*text) {
+    size += write(uint8_t(*text++));
+  }
+  return size;
+}
+
+// HARDWARE SERIAL -------------------------------------------------------------
+const unsigned int tx_buffer_size = 64;
+
+HardwareSerial::HardwareSerial(const char *port_name) {
+  name = port_name;
+  baud = 0;
+  line_handler = 0;
+  bytes_sent = 0;
+  blocked_micros = 0;
+  _tx_busy_until = 0;
+  _tx_line.reserve(256); // no heap allocations while sending
+}
+
+void HardwareSerial::begin(unsigned long new_baud) {
+  flush();
+  baud = new_baud;
+}
+
+unsigned int HardwareSerial::bytes_in_tx_buffer() {
+  if (!baud || _tx_busy_until <= current_micros) {
+    return 0;
+  }
+  unsigned long long byte_micros = 10000000ULL / baud;
+  return (unsigned int)((_tx_busy_until - current_micros + byte_micros - 1) / byte_micros);
+}
+
+int HardwareSerial::availableForWrite() { return tx_buffer_size - 1 - bytes_in_tx_buffer(); }
+
+void HardwareSerial::flush() {
+  if (_tx_busy_until > current_micros) {
+    blocked_micros += _tx_busy_until - current_micros;
+    current_micros = _tx_busy_until;
+  }
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (baud) {
+    unsigned long long byte_micros = 10000000ULL / baud;
+    // A full TX buffer blocks until one byte has been sent:
+    if (bytes_in_tx_buffer() >= tx_buffer_size - 1) {
+      unsigned long long wait = _tx_busy_until - (tx_buffer_size - 2) * byte_micros - current_micros;
+      blocked_micros += wait;
+      current_micros += wait;
+    }
+    _tx_busy_until = max(_tx_busy_until, current_micros) + byte_micros;
+  }
+  bytes_sent++;
+
+  // Lines end with a newline, Nextion commands with 0xFF:
+  if (c == '\n' || c == 0xFF) {
+    if (!_tx_line.empty() && line_handler) {
+      bool heap_counting_was_enabled = heap_counting_enabled;
+      heap_counting_enabled = false;
+      line_handler(*this, _tx_line);
+      heap_counting_enabled = heap_counting_was_enabled;
+    }
+    _tx_line.clear();
+  } else if (c != '\r') {
+    _tx_line += char(c);
+  }
+  return 1;
+}
+
+// Received bytes become available at their arrival time:
+int HardwareSerial::available() {
+  int bytes_arrived = 0;
+  while (bytes_arrived < int(_rx_buffer.size()) && _rx_buffer[bytes_arrived].first <= current_micros) {
+    bytes_arrived++;
+  }
+  return bytes_arrived;
+}
+
+int HardwareSerial::read() {
+  if (!available()) {
+    return -1;
+  }
+  uint8_t c = _rx_buffer.front().second;
+  _rx_buffer.pop_front();
+  return c;
+}
+
+int HardwareSerial::peek() { return available() ? _rx_buffer.front().second : -1; }
+
+void HardwareSerial::inject_rx(const uint8_t *data, size_t size, unsigned long long delay_micros) {
+  unsigned long long byte_micros = baud ? 10000000ULL / baud : 0;
+  unsigned long long arrival = current_micros + delay_micros;
+  for (size_t i = 0; i < size; i++) {
+    arrival += byte_micros;
+    _rx_buffer.push_back(std::make_pair(arrival, data[i]));
+  }
+}
+
+HardwareSerial Serial("Serial");
+HardwareSerial Serial1("Serial1");
+HardwareSerial Serial2("Serial2");
+
+// NEXTION LIBRARY -------------------------------------------------------------
+// Behaves like the ITEAD library, including the delay(10) per received byte.
+
+NexTouch::NexTouch(uint8_t pid, uint8_t cid, const char *name) {
+  _pid = pid;
+  _cid = cid;
+  _name = name;
+  _push = 0;
+  _push_ptr = 0;
+  _pop = 0;
+  _pop_ptr = 0;
+}
+
+void NexTouch::attachPush(NexTouchEventCb push, void *ptr) {
+  _push = push;
+  _push_ptr = ptr;
+}
+
+void NexTouch::attachPop(NexTouchEventCb pop, void *ptr) {
+  _pop = pop;
+  _pop_ptr = ptr;
+}
+
+void NexTouch::iterate(NexTouch **list, uint8_t pid, uint8_t cid, int32_t event) {
+  for (uint16_t i = 0; list[i]; i++) {
+    NexTouch *touch = list[i];
+    if (touch->_pid == pid && touch->_cid == cid) {
+      if (event == NEX_EVENT_PUSH && touch->_push) {
+        touch->_push(touch->_push_ptr);
+      } else if (event == NEX_EVENT_POP && touch->_pop) {
+        touch->_pop(touch->_pop_ptr);
+      }
+      break;
+    }
+  }
+}
+
+bool nexInit() { return true; }
+
+void nexLoop(NexTouch *nex_listen_list[]) {
+  uint8_t buffer[8];
+  while (Serial2.available() > 0) {
+    delay(10);
+    int c = Serial2.read();
+    if (c == 0x65 && Serial2.available() >= 6) {
+      buffer[0] = c;
+      for (int i = 1; i < 7; i++) {
+        buffer[i] = Serial2.read();
+      }
+      if (buffer[4] == 0xFF && buffer[5] == 0xFF && buffer[6] == 0xFF) {
+        NexTouch::iterate(nex_listen_list, buffer[1], buffer[2], buffer[3]);
+      }
+    }
+  }
+}
+
+void sendCommand(const char *cmd) {
+  while (Serial2.available()) {
+    Serial2.read();
+  }
+  Serial2.print(cmd);
+  Serial2.write(0xFF);
+  Serial2.write(0xFF);
+  Serial2.write(0xFF);
+}
+
+bool recvRetCommandFinished(uint32_t timeout) {
+  uint8_t expected[4] = {0x01, 0xFF, 0xFF, 0xFF};
+  for (int i = 0; i < 4; i++) {
+    if (Serial2.read() != expected[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// NEXTION TOUCH EVENTS --------------------------------------------------------
+void inject_nextion_touch(uint8_t page, uint8_t component, bool push) {
+  uint8_t frame[7] = {0x65, page, component, uint8_t(push ? NEX_EVENT_PUSH : NEX_EVENT_POP), 0xFF, 0xFF, 0xFF};
+  Serial2.inject_rx(frame, sizeof(frame));
+}
@@ -0,0 +1,35 @@
+/* *****************************************************************************
+ * virtual_hardware.h **********************************************************
+ * *****************************************************************************
+ * Virtual clock, pins and Nextion touch events for the native simulation.
+ * The clock only moves when the simulation advances it, or when the firmware
+ * calls delay() or blocks on a full serial TX buffer.
+ * *****************************************************************************
+ */
+
+#ifndef VIRTUALHARDWARE_H
+#define VIRTUALHARDWARE_H
+
+#include <Arduino.h>
+
+#define VIRTUAL_NO_OF_PINS 100
+
+// CLOCK -----------------------------------------------------------------------
+unsigned long long virtual_micros();
+void advance_virtual_time(unsigned long long micros_to_advance);
+
+// PINS ------------------------------------------------------------------------
+int get_virtual_output(uint8_t pin);
+void set_virtual_input(uint8_t pin, bool level);
+void set_virtual_analog_input(uint8_t pin, int adc_value);
+
+// HEAP ------------------------------------------------------------------------
+// Counts heap allocations (operator new) while counting is enabled.
+// Allocations of the serial line handlers of the simulation are not counted.
+void set_heap_counting(bool enabled);
+unsigned long long get_heap_allocations();
+
+// NEXTION ---------------------------------------------------------------------
+void inject_nextion_touch(uint8_t page, uint8_t component, bool push);
+
+#endif
@@ -0,0 +1,113 @@
+/*******************************************************************************
+ * virtual_rig.cpp *************************************************************
+ *******************************************************************************/
+
+#include "virtual_rig.h"
+#include "virtual_hardware.h"
+#include <controllino_plc/alias_colino.h>
+
+const float feed_stroke_time = 1.2; // [s] full stroke of the electrocylinder
+const float feed_initializing_time = 7.5; // [s] after logic power on
+const float sledge_return_time = 0.8; // [s] start position reached by air
+const float sledge_tension_time = 1.5; // [s] end position reached by the tool
+const float max_sledge_pressure = 5.0; // [bar] while tensioning
+const float pressure_rise_time = 0.3; // [s] time constant
+const float pressure_vent_time = 0.15; // [s] time constant
+const float knife_stroke_time = 0.12; // [s]
+
+// ADC conversions of the controllino inputs (0-10V):
+const float volts_per_unit = 0.03;
+const float max_sensor_pressure = 10; // [bar] @ 10V
+const float max_sensor_temp = 200; // [°C] @ 10V
+
+// CONSTRUCTOR -----------------------------------------------------------------
+Virtual_rig::Virtual_rig() {
+  sledge_position = 0;
+  sledge_pressure = 0;
+  feed_position = 0;
+  knife_position = 0;
+  logic_power_seconds = 0;
+  _feed_stalled = false;
+  _emergency_stop = false;
+  _temperature = 40;
+  update_inputs();
+}
+
+// SETTER ----------------------------------------------------------------------
+void Virtual_rig::set_feed_stalled(bool feed_stalled) { _feed_stalled = feed_stalled; }
+void Virtual_rig::set_emergency_stop(bool emergency_stop) { _emergency_stop = emergency_stop; }
+void Virtual_rig::set_temperature(float temperature) { _temperature = temperature; }
+
+// PLANT MODEL -----------------------------------------------------------------
+void Virtual_rig::update(unsigned long micros_elapsed) {
+  float seconds = micros_elapsed / 1e6;
+  update_feed_cylinder(seconds);
+  update_sledge(seconds);
+  update_knife(seconds);
+  update_inputs();
+}
+
+void Virtual_rig::update_feed_cylinder(float seconds) {
+  bool logic_power = get_virtual_output(CONTROLLINO_R6);
+  logic_power_seconds = logic_power ? logic_power_seconds + seconds : 0;
+
+  bool outputs_connected = get_virtual_output(CONTROLLINO_R4) && get_virtual_output(CONTROLLINO_R5);
+  if (!outputs_connected || logic_power_seconds < feed_initializing_time || _feed_stalled) {
+    return;
+  }
+  float travel = seconds / feed_stroke_time;
+  if (get_virtual_output(CONTROLLINO_D9)) { // move in
+    feed_position = min(1.0f, feed_position + travel);
+  }
+  if (get_virtual_output(CONTROLLINO_D10)) { // move out
+    feed_position = max(0.0f, feed_position - travel);
+  }
+}
+
+void Virtual_rig::update_sledge(float seconds) {
+  bool main_air = get_virtual_output(CONTROLLINO_D12);
+  bool zuluft = get_virtual_output(CONTROLLINO_D4);
+  bool abluft_closed = get_virtual_output(CONTROLLINO_R8);
+  bool spanntaste = get_virtual_output(CONTROLLINO_D5);
+
+  // Air moves the sledge back to the start position:
+  if (main_air && zuluft && abluft_closed) {
+    sledge_position = max(0.0f, sledge_position - seconds / sledge_return_time);
+  }
+
+  // The tool pulls the sledge to the end position and builds up pressure:
+  if (main_air && spanntaste && !zuluft && abluft_closed) {
+    sledge_position = min(1.0f, sledge_position + seconds / sledge_tension_time);
+    sledge_pressure += (max_sledge_pressure - sledge_pressure) * min(1.0f, seconds / pressure_rise_time);
+  }
+
+  // Open vent releases the pressure:
+  if (!abluft_closed) {
+    sledge_pressure -= sledge_pressure * min(1.0f, seconds / pressure_vent_time);
+  }
+}
+
+void Virtual_rig::update_knife(float seconds) {
+  bool knife_down = get_virtual_output(CONTROLLINO_D1) && get_virtual_output(CONTROLLINO_D12);
+  float travel = seconds / knife_stroke_time;
+  knife_position = knife_down ? min(1.0f, knife_position + travel) : max(0.0f, knife_position - travel);
+}
+
+void Virtual_rig::update_inputs() {
+  set_virtual_input(CONTROLLINO_A4, sledge_position <= 0.0f);
+  set_virtual_input(CONTROLLINO_A5, sledge_position >= 1.0f);
+  set_virtual_input(CONTROLLINO_A7, feed_position >= 1.0f);
+  set_virtual_input(CONTROLLINO_A6, feed_position <= 0.0f);
+  set_virtual_input(CONTROLLINO_A9, knife_position >= 1.0f);
+  set_virtual_input(CONTROLLINO_A10, _emergency_stop);
+  set_virtual_input(CONTROLLINO_A0, true); // strap available
+  set_virtual_input(CONTROLLINO_A1, true); // strap available
+  set_virtual_input(CONTROLLINO_A8, true); // strap not bent
+  set_virtual_input(CONTROLLINO_A11, true); // hydraulic safety ok
+  set_virtual_input(CONTROLLINO_A12, true); // hydraulic safety ok
+
+  float pressure_volts = sledge_pressure / max_sensor_pressure * 10;
+  set_virtual_analog_input(CONTROLLINO_A3, int(pressure_volts / volts_per_unit));
+  float temperature_volts = _temperature / max_sensor_temp * 10;
+  set_virtual_analog_input(CONTROLLINO_A2, int(temperature_volts / volts_per_unit));
+}
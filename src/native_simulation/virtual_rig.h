@@ -0,0 +1,50 @@
+/* *****************************************************************************
+ * virtual_rig.h ***************************************************************
+ * *****************************************************************************
+ * Simple plant model of the test rig for the native simulation.
+ * Reads the PLC outputs and sets the PLC inputs:
+ *
+ * - sledge (start and end position sensors, pressure sensor)
+ * - feed cylinder (electrocylinder with 8s initialization, in/out sensors)
+ * - clamps (no sensors, only tracked for plausibility)
+ * - knife (knife sensor)
+ * - strap, emergency stop, hydraulic safety and temperature inputs
+ * *****************************************************************************
+ */
+
+#ifndef VIRTUALRIG_H
+#define VIRTUALRIG_H
+
+#include <Arduino.h>
+
+class Virtual_rig {
+
+public:
+  // FUNCTIONS:
+  Virtual_rig();
+  void update(unsigned long micros_elapsed);
+
+  void set_feed_stalled(bool feed_stalled);
+  void set_emergency_stop(bool emergency_stop);
+  void set_temperature(float temperature);
+
+  // VARIABLES:
+  float sledge_position; // 0 = start position, 1 = end position
+  float sledge_pressure; // [bar]
+  float feed_position; // 0 = out, 1 = in
+  float knife_position; // 0 = up, 1 = cut through
+  float logic_power_seconds; // time since electrocylinder logic power on
+
+private:
+  // VARIABLES:
+  bool _feed_stalled;
+  bool _emergency_stop;
+  float _temperature;
+
+  // FUNCTIONS:
+  void update_feed_cylinder(float seconds);
+  void update_sledge(float seconds);
+  void update_knife(float seconds);
+  void update_inputs();
+};
+#endif